@@ -34,18 +34,21 @@
 #define NCCENTRIFUGE_WORLD_OBJECT_INTERFACE_H
 
 #include <exception>
+#include <list>
 #include <string>
 #include <boost/any.hpp>
 #include <boost/weak_ptr.hpp>
 #include "elements/tree.h"
 #include "elements/parameter.h"
 #include "elements/id.h"
+#include "elements/handle.h"
 
 namespace ncc {
 namespace controller
 {
     //forward declaration
     class manager;
+    namespace message { class manager; }
 
     ///Controller abstract_interface
     ///
@@ -83,6 +86,16 @@ namespace controller
             ///@param from The sender of the message.
             virtual void handle_message(const parameter& message, const parameter_list& params, abstract_interface& from) {}
 
+            ///Called after the messages of a step were delivered.
+            ///
+            ///The message manager calls this once per step on every controller
+            ///which was sent at least one message, after all messages were 
+            ///passed to handle_message. A controller can queue the messages 
+            ///in handle_message and process them together here. The message 
+            ///and parameters passed to handle_message stay valid until this 
+            ///method returns.
+            virtual void messages_delivered() {}
+
             ///Initializes a controller based on parameters sent.
             ///
             ///Override to handle custom initialization of your controller. If 
@@ -97,7 +110,24 @@ namespace controller
             virtual const std::string& get_name(){return name_holder;}
 
             ///Sets the name of the object
-            virtual void set_name(const std::string& value) {name_holder = value;}
+            ///
+            ///If the controller is managed by a controller::manager then the 
+            ///manager's name index is updated as well so that the controller 
+            ///can be found by its new name.
+            virtual void set_name(const std::string& value);
+
+            ///Adds a node as a child of the current node.
+            ///
+            ///If the current node is managed by a controller::manager then the
+            ///new child and all of its children are registered with the 
+            ///manager so that they can be found by name, id, and type.
+            virtual bool add_child(node_type new_child);
+
+            ///Removes a child from the node.
+            ///
+            ///The child and all of its children are unregistered from the 
+            ///manager which manages the current node.
+            virtual bool remove_child(node_type target_child);
 
             ///This is where all the logic of your controller should be.
             ///
@@ -108,6 +138,66 @@ namespace controller
             ///otherwise false.
             virtual bool control() {return true;}
 
+            ///Returns true if the controller can be controlled in parallel.
+            ///
+            ///When the controller manager steps in parallel, each child of
+            ///the root controller which returns true is controlled, along
+            ///with its children, on a thread pool at the same time as other
+            ///such subtrees. Override to return true only if the control
+            ///methods of the controller and its children touch nothing but
+            ///their own subtree and the controller manager. Adding, removing,
+            ///and sending messages through the manager are buffered during
+            ///the parallel step.
+            ///@see ncc::controller::manager::enable_parallel_step
+            virtual bool is_thread_safe() const {return false;}
+
+            ///Sets how often the controller is controlled.
+            ///
+            ///By default a controller is controlled on every step. A 
+            ///controller which does not need to run that often, such as 
+            ///ambient AI or a spawner, can set an interval and the manager 
+            ///skips its control method until the interval has passed. The 
+            ///children of a skipped controller are still visited.
+            ///@param seconds The least time between two calls to control. 
+            ///0 means every step.
+            void set_update_interval(double seconds) {update_interval = seconds;}
+
+            ///Returns the least time between two calls to control.
+            double get_update_interval() const {return update_interval;}
+
+            ///Sets whether the control of the controller can be spread over 
+            ///several steps.
+            ///
+            ///The controller manager spreads low priority controllers over 
+            ///buckets and controls one bucket each step. If a step runs out 
+            ///of its time budget, the rest of the bucket is controlled on the
+            ///next step.
+            ///@see ncc::controller::manager::set_time_budget
+            void set_low_priority(bool value) {low_priority = value;}
+
+            ///Returns true if the controller is low priority.
+            bool is_low_priority() const {return low_priority;}
+
+            ///Puts the controller to sleep until it is woken.
+            ///
+            ///A sleeping controller and all of its children are skipped by 
+            ///ncc::controller::manager::step. Controllers which only react to 
+            ///messages or collisions can sleep and cost nothing until then, 
+            ///because a controller is woken when it is sent a message.
+            void sleep();
+
+            ///Puts the controller to sleep for the specified time.
+            ///
+            ///The controller is woken by the first step after the time has 
+            ///passed or earlier by a message.
+            void sleep(double seconds);
+
+            ///Wakes the controller so that it is controlled on the next step.
+            void wake() {sleeping = false; wake_time = 0;}
+
+            ///Returns true if the controller is asleep.
+            bool is_sleeping() const {return sleeping;}
+
             ///Returns true if the controller is still alive.
             ///
             ///This method is primarily used by the controller manager to 
@@ -118,18 +208,44 @@ namespace controller
             ///because it invalidates iterators.
             bool is_alive() const {return alive;}
 
+            ///Returns the handle of the controller in its manager.
+            ///
+            ///The handle is null until the controller is added to a 
+            ///controller::manager and becomes invalid when the controller is 
+            ///removed from it. Keeping a handle instead of a pointer to a 
+            ///controller is safe because the manager returns 0 for handles 
+            ///of controllers which are gone.
+            ///@see ncc::controller::manager::get_controller
+            const handle& get_handle() const {return handle_holder;}
+
             ///This is the default constructor for the abstract_interface.
             ///
             ///It is important to call this constructor in derived classes 
             ///constructor. When you derive from ncc::controller::abstract_interface
             ///and have custom constructors, call this constructor at the end of 
             ///the initialization list.
-            explicit abstract_interface() : name_holder(), alive(true), tree::is_node<abstract_interface>(this), id_type(){};
+            explicit abstract_interface() : 
+                name_holder(), 
+                alive(true), 
+                queued(false),
+                manager_ptr(0), 
+                handle_holder(),
+                update_interval(0), 
+                next_control(0), 
+                low_priority(false),
+                controlled_round(0),
+                sleeping(false),
+                wake_time(0),
+                delivery_round(0),
+                tree::is_node<abstract_interface>(this), 
+                id_type(){};
 
             virtual ~abstract_interface(){};			
         protected:
             //Give the manager class access to the clone_prototype method.
             friend class manager;
+            //Give the message manager access to the delivery round.
+            friend class message::manager;
 
             ///Returns a pointer to a newly created clone on the heap
             ///
@@ -140,11 +256,44 @@ namespace controller
             ///succeed. 
             ///@return A clone of the controller in an uninitialized state. 
             virtual abstract_interface* clone_prototype() {return 0;}
-            void remove_self(){alive = false;}
+
+            ///Prepares a dead controller to be initialized again.
+            ///
+            ///Controllers created from a prototype which has a pool are 
+            ///recycled instead of destroyed. The manager resets the name, 
+            ///children, id, and scheduling of the controller and then calls 
+            ///this method, which should put the controller back in the state 
+            ///of a fresh clone so that initialize can be called on it again. 
+            ///It is also called on the clones made to warm up a pool.
+            ///@return True if the controller can be reused. The default 
+            ///returns false so that the controller is destroyed.
+            ///@see ncc::controller::manager::set_prototype_pool
+            virtual bool recycle() {return false;}
+
+            ///Marks the controller as dead.
+            ///
+            ///The controller is put on its manager's list of dead controllers
+            ///and is removed, with its children, at the end of the next 
+            ///ncc::controller::manager::step.
+            void remove_self();
         private:
             std::string name_holder; ///< Holds the name of the controller. 
             bool alive; ///< If false then the controller is destroyed at the 
             ///end of ncc::controller::manager::step() method.
+            bool queued; ///< true while the controller is on its manager's 
+            ///list of dead controllers.
+            manager* manager_ptr; ///< The manager which indexes the controller,
+            ///0 if the controller is not managed.
+            handle handle_holder; ///< The handle of the controller in manager_ptr.
+            double update_interval; ///< 0 if controlled every step.
+            double next_control; ///< when the controller is due again.
+            bool low_priority;
+            unsigned long controlled_round; ///< the last round of low priority
+            ///buckets the controller was controlled in.
+            bool sleeping;
+            double wake_time; ///< 0 if only woken explicitly.
+            unsigned long delivery_round; ///< the last send_messages call 
+            ///which delivered a message to the controller.
 
     };
 
@@ -42,9 +42,18 @@
 #include <boost/utility.hpp>
 #include <boost/bind.hpp>
 #include <boost/functional/hash.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/tss.hpp>
 #include "controller/controller_interface.h"
+#include "elements/handle.h"
 #include "utilities/cache.h"
 #include "utilities/multi_cache.h"
+#include "utilities/thread_pool.h"
 #include "controller/message_manager.h"
 namespace ncc {
 namespace controller
@@ -76,6 +85,27 @@ namespace controller
     class manager : boost::noncopyable
     {
         public:
+            ///Adds parameters to a message being sent and posts the message
+            ///when the expression sending it ends.
+            ///
+            ///A message posted from another thread can be delivered as soon 
+            ///as it is posted, so it is only posted once it is complete.
+            ///Copying hands the message over, so only the last copy posts it.
+            class message_builder
+            {
+                public:
+                    ///Adds a parameter to the message.
+                    message_builder& operator()(const parameter& param) { msg->message_parcel(param); return *this;}
+                    message_builder(const message_builder& other) : owner(other.owner), msg(other.msg) { other.owner = 0;}
+                    ~message_builder() { if(owner) owner->post_message(msg);}
+                private:
+                    friend class manager;
+                    message_builder(manager* sending_manager, const message::ptr& new_message) : owner(sending_manager), msg(new_message) {}
+                    message_builder& operator=(const message_builder&);
+                    mutable manager* owner;
+                    message::ptr msg;
+            };
+
             ///Adds a prototype for creation purposes.
             ///
             ///There are several requirements for a prototype
@@ -87,8 +117,34 @@ namespace controller
             ///prototype has already been added then nothing happens.
             ///@param name The name for the prototype so that you can refer to it 
             ///somehow. 
+            ///\n\n
+            ///A prototype added during the parallel part of step can only be 
+            ///created from once the parallel part is over.
             void add_prototype(const std::string& name, ptr& prototype);
 
+            ///Keeps the dead controllers created from a prototype for reuse.
+            ///
+            ///When a controller created from the prototype dies, it is 
+            ///recycled instead of destroyed and create_controller hands it 
+            ///out again, calling its initialize method with the new 
+            ///parameters. This saves the cost of cloning, which for a script 
+            ///controller means creating a lua_State, binding the library, 
+            ///and loading the script. Only controllers whose recycle method 
+            ///returns true are kept. A controller is recycled by step when it
+            ///is removed and nothing else holds it, so its recycle method 
+            ///runs on the thread calling step. A removed controller which is
+            ///still held, such as by a script, is recycled by a later step 
+            ///once it is released.
+            ///@param name The name of the prototype.
+            ///@param size The most controllers the pool keeps. 0 removes the
+            ///pool.
+            ///@param warm_up The number of controllers to clone now, so that 
+            ///the first ones created do not have to be cloned.
+            ///\n\n
+            ///A pool set during the parallel part of step is only made once 
+            ///the parallel part is over.
+            void set_prototype_pool(const std::string& name, std::size_t size, std::size_t warm_up = 0);
+
             ///Adds a controller to manage.
             ///
             ///Adds a controller to manager. It is recommended that the new 
@@ -157,7 +213,7 @@ namespace controller
 
             ///Removes a controller with the specified id.
             ///@param value 
-            void remove_controller(id_type value);
+            void remove_controller(const id_type& value);
 
             ///removes a specific controller.
             ///
@@ -166,16 +222,27 @@ namespace controller
 
             ///Finds a controller with the specified name.
             ///
-            ///Returns a controller with the specified name. The first one found is 
-            ///returned. 
+            ///Returns a controller with the specified name. If several 
+            ///controllers share the name then any one of them is returned. 
+            ///The lookup uses a hash index and does not depend on the number 
+            ///of controllers managed.
             weak_ptr find_controller(const std::string& name);
 
             ///Finds a controller with the specified id value
             ///
-            ///Returns a controller of the specified name. First one found is 
-            ///returned.
+            ///Returns the controller with the specified id. The lookup uses a 
+            ///hash index and does not depend on the number of controllers 
+            ///managed.
             weak_ptr find_controller(const id_type& value);
 
+            ///Returns the controller a handle refers to.
+            ///
+            ///Every controller the manager manages has a handle, see 
+            ///ncc::controller::abstract_interface::get_handle. The lookup is 
+            ///an array access and touches no reference count.
+            ///@return The controller or 0 if it is no longer managed.
+            abstract_interface* get_controller(const handle& value) const {return handles.get(value);}
+
             ///Finds controllers of the specified name.
             ///
             ///This method unlike the find_controller methods can find more than one 
@@ -202,6 +269,58 @@ namespace controller
             ///logic called.
             void step();
 
+            ///Makes step control independent subtrees in parallel.
+            ///
+            ///Each child of the root controller whose is_thread_safe method
+            ///returns true is controlled with its children on a work
+            ///stealing thread pool. The other subtrees are controlled one
+            ///after another once the parallel subtrees are done. Controllers,
+            ///names, and messages added, removed, or sent during the parallel
+            ///part are buffered per subtree and applied in the order of the
+            ///subtrees before messages are sent, so the result does not
+            ///depend on how the threads were scheduled. Prototypes and pools
+            ///are buffered as well, so that create_controller can look them 
+            ///up from any thread.
+            ///@param threads The number of threads to use, counting the one
+            ///calling step. If 0 then the number of hardware threads is used.
+            ///@see ncc::controller::abstract_interface::is_thread_safe
+            void enable_parallel_step(unsigned int threads = 0);
+
+            ///Makes step control every controller on the calling thread.
+            void disable_parallel_step();
+
+            ///Sets how long a step may take before low priority controllers 
+            ///are put off.
+            ///
+            ///Once a step has taken longer than the budget, the low priority 
+            ///controllers of the current bucket which were not controlled yet
+            ///wait for the next step, which continues the same bucket. This 
+            ///keeps the frame time flat as the number of controllers grows.
+            ///@param seconds The budget of a step. 0 means there is no budget.
+            ///@see ncc::controller::abstract_interface::set_low_priority
+            void set_time_budget(double seconds) {time_budget = seconds;}
+
+            ///Sets the number of buckets low priority controllers are spread 
+            ///over.
+            ///
+            ///Each step controls one bucket, so a low priority controller is 
+            ///controlled once every so many steps. The default is 4.
+            void set_low_priority_buckets(unsigned int buckets) {low_priority_buckets = buckets ? buckets : 1;}
+
+            ///Starts or stops keeping statistics of the messages sent.
+            ///
+            ///Statistics include the number of messages pending and 
+            ///delivered each step, how long messages wait to be delivered, 
+            ///and which messages are sent the most. They are off by default.
+            ///@see ncc::controller::message::statistics
+            void enable_message_statistics(bool enable) {message_manager.enable_statistics(enable);}
+
+            ///Returns the statistics of the messages sent.
+            const message::statistics& get_message_statistics() const {return message_manager.get_statistics();}
+
+            ///Resets the statistics of the messages sent.
+            void clear_message_statistics() {message_manager.clear_statistics();}
+
             ///Sends a message to other controllers with the specified name.
             ///
             ///This method is usually called within a controller. Therefore the 
@@ -233,13 +352,14 @@ namespace controller
             ///Example 3: manager.send_message(this, "player", "push")(20)(3)(3); //push the player with 3 parameters.
             ///\n\n
             ///In example 3 demonstrates can specify as many parameters of any type 
-            ///as you want by adding more () after the function call.
+            ///as you want by adding more () after the function call. The 
+            ///message is sent once the last parameter is added.
             ///@param sender This is a pointer of the sender.
             ///@param name The name of the controller you want to send a message to.
             ///@param message This is the message you would like to send to the 
             ///controllers.
             ///@see ncc::parameter
-            message::parcel& send_message(abstract_interface* sender, 
+            message_builder send_message(abstract_interface* sender, 
                     const std::string& name, 
                     const parameter& message);
 
@@ -269,7 +389,7 @@ namespace controller
                     ptr& recipient,
                     const message::parcel& message);
             ///Sends a message to a specific controller.
-            message::parcel& send_message(abstract_interface* sender, 
+            message_builder send_message(abstract_interface* sender, 
                     ptr& recipient, 
                     const parameter& message);        
             ///Sends a message to a specific controller.
@@ -283,7 +403,7 @@ namespace controller
                     const std::string& type, 
                     const message::parcel& message);
             ///Sends a message to all controllers of a certain type.
-            message::parcel& send_message_to_all(abstract_interface* sender, 
+            message_builder send_message_to_all(abstract_interface* sender, 
                     const std::string& type, 
                     const parameter& message);        
             ///Sends  a message to all controllers of a certain type.
@@ -296,7 +416,7 @@ namespace controller
             void send_message_to_all(abstract_interface* sender, 
                     const message::parcel& message);
             ///Sends a message to all controllers.
-            message::parcel& send_message_to_all(abstract_interface* sender,
+            message_builder send_message_to_all(abstract_interface* sender,
                     const parameter& message);
             ///Sends a message to all controllers.
             void send_message_to_all(abstract_interface* sender,
@@ -306,24 +426,153 @@ namespace controller
             manager();
 
         private:
+            //Give controllers access to the index methods.
+            friend class abstract_interface;
+            //Give the message manager access to the indices to route messages.
+            friend class message::manager;
 
             ///Finds a prototype of a specific type and returns a weak_ptr to it.
             weak_ptr find_prototype(const std::string& type);    
 
             ///Creates a flat list of controllers in depth first order.
             void create_flat_list(list& controllers);
+
+            ///Adds a controller and all of its children to the name, id, and 
+            ///type indices.
+            void index_controller(ptr& controller);
+
+            ///Removes a controller and all of its children from the name, id, 
+            ///and type indices.
+            void unindex_controller(ptr& controller);
+
+            ///Moves a controller from one bucket of the name index to another.
+            void rename_controller(abstract_interface& controller, 
+                    const std::string& old_name, 
+                    const std::string& new_name);
+
+            ///Holds recycled controllers of a prototype.
+            ///
+            ///The pools are owned by the manager. Controllers created from a
+            ///pooled prototype only hold a weak pointer to their pool in 
+            ///their deleter, so a pool dies with the manager or when it is 
+            ///removed and the controllers still alive are then deleted.
+            struct controller_pool : boost::noncopyable
+            {
+                controller_pool() : capacity(0) {}
+                ~controller_pool();
+                std::vector<abstract_interface*> free;
+                std::size_t capacity;
+                boost::mutex lock;
+            };
+            typedef boost::shared_ptr<controller_pool> pool_ptr;
+
+            ///The deleter of pooled controllers.
+            struct recycler
+            {
+                boost::weak_ptr<controller_pool> pool;
+                bool recycled; ///< true once reclaim_controllers reset the controller.
+                void operator()(abstract_interface* controller) const { recycle_controller(*this, controller);}
+            };
+
+            ///Puts a recycled controller in its pool, or deletes it if it 
+            ///was not recycled, the pool is gone, or the pool is full.
+            static void recycle_controller(const recycler& deleter, abstract_interface* controller);
+
+            ///Resets the pooled controllers of a dead subtree which die with 
+            ///it, children first. Pooled controllers which are still held 
+            ///elsewhere are put back on the dead list.
+            void recycle_dead_controller(ptr& controller);
+
+            ///Resets the state every controller has and calls its recycle 
+            ///method.
+            static bool reset_controller(abstract_interface& controller);
+
+            ///Takes a controller out of the pool of a prototype. Returns 0 if
+            ///the prototype has no pool or the pool is empty.
+            ptr take_pooled_controller(const std::string& type);
+
+            ///Calls the controller's control method if it is due.
+            ///
+            ///Used as the visitor of the step traversal. Controllers with an 
+            ///update interval or low priority are skipped until they are due.
+            bool control_scheduled(ptr& controller);
+
+            ///Puts a controller which called remove_self on the dead list.
+            void queue_removal(const ptr& controller);
+
+            ///Puts a controller on the dead list unless it is already on it.
+            void queue_dead_controller(const ptr& controller);
+
+            ///Detaches the controllers on the dead list from the tree.
+            ///
+            ///Only the dead controllers are visited, so the cost depends on
+            ///the number of controllers which died and not on the number of
+            ///controllers managed.
+            void reclaim_controllers();
+
+            ///Adds the message to the message manager, or to the buffer of
+            ///the subtree being controlled during a parallel step.
+            void post_message(message::ptr& msg);
+            friend class message_builder;
+
+            ///A change to the controller tree or its indices delayed until
+            ///the parallel part of step is over.
+            typedef boost::function<void()> change;
+            typedef std::vector<change> change_list;
+
+            ///Buffers the change if the calling thread is controlling a
+            ///subtree in parallel. Returns false if the change should be
+            ///made now.
+            bool defer(const change& delayed);
+
+            ///Controls the subtrees of the root controller on the thread
+            ///pool.
+            void control_parallel();
+
+            ///Controls a subtree with changes going to the buffer specified.
+            void control_subtree(ptr& subtree, change_list* changes);
         private:
 
 #ifdef WIN32
             typedef std::map<std::string, ptr> prototype_map;
+            typedef std::map<std::string, pool_ptr> pool_map;
+            typedef std::map<unsigned long, handle> id_map;
+            typedef std::map<std::string, id_map> string_index;
 #else
             ///The prototype_map is a hash map for fast lookup.
             typedef std::tr1::unordered_map<std::string, ptr, boost::hash<std::string> > prototype_map;
+            ///The pool_map holds the pools of the prototypes which have one.
+            typedef std::tr1::unordered_map<std::string, pool_ptr, boost::hash<std::string> > pool_map;
+            ///The id_map is a hash map of the handles of controllers keyed by
+            ///their id.
+            typedef std::tr1::unordered_map<unsigned long, handle> id_map;
+            ///The string_index groups controllers by a string such as their 
+            ///name or type.
+            typedef std::tr1::unordered_map<std::string, id_map, boost::hash<std::string> > string_index;
 #endif
 
             ptr root_controller; 
+            handle_table<abstract_interface> handles; ///< of the managed controllers.
             prototype_map prototypes;
+            pool_map pools;
+            id_map id_index;
+            string_index name_index;
+            string_index type_index;
             message::manager message_manager;
+
+            boost::scoped_ptr<thread_pool> pool; ///< 0 unless stepping in parallel.
+            thread_pool::task_list subtree_tasks;
+            std::vector<ptr> sequential_subtrees;
+            std::vector<change_list> subtree_changes; ///< one per parallel subtree.
+            std::vector<ptr> dead_controllers; ///< removed at the end of step.
+
+            double time_budget;
+            double step_start;
+            unsigned int low_priority_buckets;
+            unsigned long low_priority_round; ///< the bucket is this modulo the bucket count.
+            boost::atomic<bool> round_cut; ///< true if the budget ran out during the step.
+            boost::atomic<boost::thread::id> step_thread; ///< the thread which calls step.
+            boost::thread_specific_ptr<change_list> deferred_changes;
     };
 
     namespace hidden
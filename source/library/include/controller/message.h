@@ -33,8 +33,8 @@
 #define NCCENTRIFUGE_MESSAGE_H
 
 #include <boost/shared_ptr.hpp>
-#include <boost/timer.hpp>
 #include "elements/parameter.h"
+#include "utilities/clock.h"
 namespace ncc {
 namespace controller {
 namespace message
@@ -59,10 +59,44 @@ namespace message
         ///Where MyCustomCondition a condition you made based on the condition 
         ///interface. The second line creates
         ///a parcel which will be sent only when myCondition is met.
+        ///\n\n
+        ///By default send is checked every time the message manager sends 
+        ///messages. A condition can avoid this by overriding wake_time, or 
+        ///poll_interval, so that the message manager schedules the message 
+        ///instead.
         ///@ingroup interfaces
         struct interface
         {
             virtual bool send() const = 0;
+
+            ///Returns the time, as given by ncc::monotonic_seconds, before 
+            ///which send is known to return false. 
+            ///
+            ///The message manager does not check send until this time. A 
+            ///value of 0 means the time is not known.
+            virtual double wake_time() const {return 0;}
+
+            ///Returns the number of seconds between two checks of send.
+            ///
+            ///A value of 0 means send is checked every time the message 
+            ///manager sends messages.
+            virtual double poll_interval() const {return 0;}
+
+            virtual ~interface(){}
+        };
+
+        ///A condition which is checked at a fixed interval.
+        ///
+        ///This is the base of the pre-made conditions that wrap a predicate 
+        ///or a variable. The interval is given in seconds. An interval of 0 
+        ///means the condition is checked every time the message manager 
+        ///sends messages.
+        struct polled : public interface
+        {
+            polled(double interval) : interval_holder(interval) {}
+            double poll_interval() const {return interval_holder;}
+            private:
+            double interval_holder;
         };
         typedef boost::shared_ptr<condition::interface> ptr;    
     }
@@ -144,6 +178,17 @@ namespace message
             ///Returns true if the message is to be sent.
             bool send() const;
 
+            ///Returns the time before which the message is not sent.
+            ///@see ncc::controller::message::condition::interface::wake_time
+            double wake_time() const;
+
+            ///Returns the number of seconds between two checks of the condition.
+            ///@see ncc::controller::message::condition::interface::poll_interval
+            double poll_interval() const;
+
+            ///Returns true if the message is sent only when a condition is met.
+            bool is_conditional() const {return type == conditional;}
+
             ///Useful operator to easly chain parameters.
             ///
             ///Use this function to chain parameters. Example:
@@ -170,21 +215,27 @@ namespace message
     {
         ///A condition which sends a message after a certain amount of second
         ///elapse.
+        ///
+        ///The seconds are measured in wall time using a monotonic clock. The 
+        ///message manager schedules the message for the time it is due so 
+        ///the condition costs nothing until then.
         struct timed : public interface
         {
-            timed(double seconds) : send_time(seconds), time() {}
-            bool send() const {return time.elapsed() >= send_time;}
+            timed(double seconds) : send_time(monotonic_seconds() + seconds) {}
+            bool send() const {return monotonic_seconds() >= send_time;}
+            double wake_time() const {return send_time;}
             private:
             const double send_time;
-            boost::timer time;
         };
 
         ///A condition which sends a message when a variable is less than a 
         ///specific value.
+        ///
+        ///The optional interval is the number of seconds between checks.
         template <class type>
-            struct less_than_value : public interface
+            struct less_than_value : public polled
         {
-            less_than_value(const type& variable, const type& value) : variable_ref(variable), value_holder(value){}
+            less_than_value(const type& variable, const type& value, double interval = 0) : polled(interval), variable_ref(variable), value_holder(value){}
             bool send() const {return variable_ref < value_holder;}
             private:
             const type& variable_ref;
@@ -193,10 +244,12 @@ namespace message
 
         ///A condition which sends a message when a variable is less than 
         ///another variable. 
+        ///
+        ///The optional interval is the number of seconds between checks.
         template <class type>
-            struct less_than_variable : public interface
+            struct less_than_variable : public polled
         {
-            less_than_variable(const type& variable, const type& value) : variable_ref(variable), value_ref(value){}
+            less_than_variable(const type& variable, const type& value, double interval = 0) : polled(interval), variable_ref(variable), value_ref(value){}
             bool send() const {return variable_ref < value_ref;}
             private:
             const type& variable_ref;
@@ -205,10 +258,12 @@ namespace message
 
         ///A condition which sends a message when a variable is equal to 
         ///another value.
+        ///
+        ///The optional interval is the number of seconds between checks.
         template <class type>
-            struct equal_to_value : public interface
+            struct equal_to_value : public polled
         {
-            equal_to_value(const type& variable, const type& value) : variable_ref(variable), value_holder(value){}
+            equal_to_value(const type& variable, const type& value, double interval = 0) : polled(interval), variable_ref(variable), value_holder(value){}
             bool send() const {return variable_ref == value_holder;}
             private:
             const type& variable_ref;
@@ -217,10 +272,12 @@ namespace message
 
         ///A condition which sends a message when a variable is equal to another 
         ///variable.
+        ///
+        ///The optional interval is the number of seconds between checks.
         template <class type>
-            struct equal_to_variable : public interface
+            struct equal_to_variable : public polled
         {
-            equal_to_variable(const type& variable, const type& value) : variable_ref(variable), value_ref(value){}
+            equal_to_variable(const type& variable, const type& value, double interval = 0) : polled(interval), variable_ref(variable), value_ref(value){}
             bool send() const {return variable_ref == value_ref;}
             private:
             const type& variable_ref;
@@ -228,11 +285,15 @@ namespace message
         };
 
         ///A condition which negates another condition.
+        ///
+        ///The negated condition is checked as often as the condition it 
+        ///negates.
         template<class condition_type>
             struct is_not : public interface
         {
             is_not(const condition_type& condition) : condition_holder(condition){}
             bool send() const  {return !condition_holder.send();}
+            double poll_interval() const {return condition_holder.poll_interval();}
             private:
             condition_type condition_holder;
         };
@@ -243,10 +304,12 @@ namespace message
         ///This condition can be used to send a message when a simple predicate 
         ///is true. the predicate must be of a simple signiture of 
         ///"bool predicate()" where takes no parameters and returns a boolean.
+        ///The optional interval is the number of seconds between checks, so an 
+        ///expensive predicate does not have to be called every frame.
         template <class predicate_type>
-            struct if_true : public interface
+            struct if_true : public polled
         {
-            if_true(const predicate_type& predicate) : predicate_holder(predicate) {}
+            if_true(const predicate_type& predicate, double interval = 0) : polled(interval), predicate_holder(predicate) {}
             bool send() const {return predicate_holder();}
             private:
             predicate_type predicate_holder;
@@ -35,11 +35,16 @@
 
 #include <list>
 #include <vector>
+#include <queue>
 #include <algorithm>
 #include <boost/utility.hpp>
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include <boost/pool/pool_alloc.hpp>
+#include "utilities/mpsc_queue.h"
+#include "utilities/free_list_allocator.h"
 #include "controller/message.h"
+#include "controller/message_stats.h"
 #include "controller/controller_interface.h"
 namespace ncc {
 namespace controller {
@@ -51,32 +56,113 @@ namespace message
     ///
     ///This class is exclusively used ncc::controller::message::manager. It 
     ///stores several pieces of information which are important in sending a 
-    ///message to the right recipient. One feature is that it holds a callback 
-    ///to a method which determines if a controller is a recipient. This is 
-    ///important because the existence of recipients can change from one frame 
-    ///to another. Note the only way to create a message is by the constructor. 
-    ///This class is meant to be used by the library only.
-    struct message : boost::noncopyable
+    ///message to the right recipient. Instead of asking every controller if 
+    ///it is a recipient, a message holds a route which says how its 
+    ///recipients are found. A message can be routed to a specific 
+    ///controller, to all controllers with a name, to all controllers of a 
+    ///type, or to every controller. The recipients are looked up when the 
+    ///message is sent because the existence of recipients can change from 
+    ///one frame to another. Note the only way to create a message is by the 
+    ///constructor. This class is meant to be used by the library only.
+    ///A message is its own node in the queue of messages posted from other 
+    ///threads.
+    struct message : mpsc_node, boost::noncopyable
     {
-        ///Constructs a message. 
+        ///The ways a message can find its recipients.
+        enum route_type 
+        {
+            to_controller,  ///< sent to the recipient controller.
+            to_name,        ///< sent to all controllers named target.
+            to_type,        ///< sent to all controllers of type target.
+            to_all          ///< sent to every controller.
+        };
+
+        ///Constructs a message to a specific controller. 
         ///@param sender A raw pointer to the sender controller
-        ///@param is_recipient_callback This is a callback which determines if a 
-        ///controller is a recipient of the message. 
+        ///@param recipient_controller The handle of the controller which 
+        ///receives the message. 
         ///@param msg_parcel This is the actual message which needs to be sent. 
         message(abstract_interface* sender, 
-                const boost::function<bool (ptr&)>& is_recipient_callback, 
+                const handle& recipient_controller, 
                 const parcel& msg_parcel) : 
-            is_recipient(is_recipient_callback),
+            route(to_controller),
+            recipient(recipient_controller),
+            target(),
             from(sender),
             message_parcel(msg_parcel),
-            sent(false) {}
-        boost::function<bool (ptr)> is_recipient;
+            sent(false),
+            added_time(0) {}
+
+        ///Constructs a message to a specific controller from a message and
+        ///its parameters. 
+        ///
+        ///The parcel is made in place so the parameters are copied once.
+        message(abstract_interface* sender, 
+                const handle& recipient_controller, 
+                const parameter& msg, 
+                const parameter_list& params) : 
+            route(to_controller),
+            recipient(recipient_controller),
+            target(),
+            from(sender),
+            message_parcel(msg, params),
+            sent(false),
+            added_time(0) {}
+
+        ///Constructs a message which is routed by name, type, or to all.
+        ///@param sender A raw pointer to the sender controller
+        ///@param message_route How the recipients are found.
+        ///@param route_target The name or type of the recipients. Ignored 
+        ///when the route is to_all.
+        ///@param msg_parcel This is the actual message which needs to be sent. 
+        message(abstract_interface* sender, 
+                route_type message_route,
+                const std::string& route_target,
+                const parcel& msg_parcel) : 
+            route(message_route),
+            recipient(),
+            target(route_target),
+            from(sender),
+            message_parcel(msg_parcel),
+            sent(false),
+            added_time(0) {}
+
+        ///Constructs a message which is routed by name, type, or to all 
+        ///from a message and its parameters.
+        ///
+        ///The parcel is made in place so the parameters are copied once.
+        message(abstract_interface* sender, 
+                route_type message_route,
+                const std::string& route_target,
+                const parameter& msg, 
+                const parameter_list& params) : 
+            route(message_route),
+            recipient(),
+            target(route_target),
+            from(sender),
+            message_parcel(msg, params),
+            sent(false),
+            added_time(0) {}
+
+        route_type route;
+        handle recipient;
+        std::string target;
         abstract_interface* from;
         parcel message_parcel;
         bool sent;
+        double added_time; ///< when the message was added, if statistics are kept.
+        ///Keeps the message alive while it is in the posted queue.
+        boost::shared_ptr<message> posted;
     };
     typedef boost::shared_ptr<message> ptr;
 
+    ///Allocates messages, with boost::allocate_shared, from a lock free 
+    ///free list which keeps the memory of delivered messages for new ones, 
+    ///so that threads posting messages do not take a lock to allocate them.
+    ///The message's name and the contents of its parameters are still 
+    ///allocated from the heap when they do not fit in the message.
+    typedef free_list_allocator<message> allocator;
+
 
     ///Used by ncc::controller::manager to manage messages which are sent from 
     ///controller to controller.
@@ -85,8 +171,10 @@ namespace message
     ///controller manager does is add messages to the manager and the manager 
     ///takes care of the rest. There are only two methods to the class, one to 
     ///add a message, and one which sends the messages already in the queue.
-    ///controller manager gives the message manager its root node and the 
-    ///manager does the rest. 
+    ///controller manager gives the message manager itself and the message 
+    ///manager uses its name, id, and type indices to find the recipients of 
+    ///each message. The cost of sending a message therefore depends on the 
+    ///number of recipients and not the number of controllers. 
     ///\n\n
     ///There are several important requirements for the message to be sent.
     ///The sender and the reciever of the message must still exist or the 
@@ -97,22 +185,106 @@ namespace message
         public:
             ///Adds a message to the message manager.
             ///
+            ///Messages whose condition has a wake_time or a poll_interval are 
+            ///scheduled and cost nothing until they are due. All other 
+            ///messages are checked every time send_messages is called.
             ///@param msg A boost::shared_ptr of a new 
             ///ncc::controller::message::message object.
             void add_message(ptr& msg);
-            ///sends all messages to the proper recipients in the controller tree 
-            ///specified by the root parameter.
+
+            ///Adds a message from any thread.
             ///
-            ///This method transverses the controller tree from the root node in a
-            ///depth first type fashion. For each controller it comes across it 
-            ///goes through all messages and determines if the controller is a 
-            ///recipient of any of the messages. If it is the message is passed to 
-            ///the controller's handle_message method.
-            ///@param root The root of the controller tree the messages will be sent.
-            void send_messages(controller::ptr& root);
+            ///The message is put in a lock free queue which is emptied at the
+            ///start of send_messages, on the thread which sends the messages.
+            ///Posting does not allocate or lock. Parameters should not be added 
+            ///to the message's parcel after it is posted.
+            void post_message(const ptr& msg);
+            ///sends all messages to the proper recipients managed by the 
+            ///controllers parameter.
+            ///
+            ///For each message which is ready to be sent, the recipients are 
+            ///looked up by following the message's route and the message is 
+            ///passed to each recipient's handle_message method. Messages added 
+            ///while sending are sent on the next call. Every recipient then 
+            ///has its messages_delivered method called once.
+            ///@param controllers The controller manager whose controllers the 
+            ///messages will be sent to.
+            void send_messages(controller::manager& controllers);
+
+            ///Starts or stops keeping statistics.
+            ///
+            ///While statistics are kept, every call to send_messages is 
+            ///counted as a frame. Stopping does not clear the statistics.
+            void enable_statistics(bool enable) {keep_statistics = enable;}
+
+            ///Returns the statistics kept so far.
+            const statistics& get_statistics() const {return stats;}
+
+            ///Resets the statistics.
+            void clear_statistics() {stats.clear(); current.clear();}
+
+            manager() : schedule_count(0), delivery_round(0), keep_statistics(false) {}
+            ~manager();
         private:
-            typedef std::list<ptr> message_list;
+            ///Adds the messages posted from other threads.
+            void add_posted_messages();
+
+            ///Sends the messages which are ready.
+            void deliver_messages(controller::manager& controllers);
+
+            ///Fills the recipients list with the recipients of the message.
+            ///@return The number of index entries or controllers visited.
+            std::size_t find_recipients(controller::manager& controllers, message& msg);
+
+            ///Counts a message delivered to the recipients found for it.
+            void count_delivery(const message& msg, double now);
+
+            ///Adds the counters of the current frame to the statistics.
+            void end_frame(double start);
+
+            ///Puts the message in the schedule to be checked at a certain time.
+            void schedule_message(const ptr& msg, double time);
+
+            ///Moves the scheduled messages which are ready to the message list
+            ///and reschedules the rest.
+            void wake_messages();
+
+            ///A message waiting in the schedule.
+            struct scheduled_message
+            {
+                double time;        ///< when the message is checked next.
+                unsigned long order; ///< keeps messages due at the same time in order.
+                ptr msg;
+                ///Reversed so that the std::priority_queue is a min heap.
+                bool operator < (const scheduled_message& rhs) const 
+                {
+                    return time != rhs.time ? time > rhs.time : order > rhs.order;
+                }
+            };
+            typedef std::priority_queue<scheduled_message> message_schedule;
+
+            ///The list nodes come from a pool so that adding a message does 
+            ///not allocate once the pool has grown.
+            typedef std::list<ptr, boost::fast_pool_allocator<ptr> > message_list;
             message_list messages;
+            message_schedule schedule;
+            unsigned long schedule_count;
+            mpsc_queue<message> posted;
+
+            ///Holds the handles of the recipients of the message being sent.
+            ///Kept between calls so that it does not have to be reallocated.
+            ///A recipient removed by the handle_message of another is 
+            ///skipped because its handle is released.
+            std::vector<handle> recipients;
+
+            ///The controllers which were delivered a message by the current 
+            ///send_messages call.
+            std::vector<handle> delivered;
+            unsigned long delivery_round;
+
+            bool keep_statistics;
+            statistics stats;
+            statistics::frame current; ///< the counters of the frame being sent.
     };
 
 }//namespace message
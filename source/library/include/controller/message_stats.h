@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#ifndef NCCENTRIFUGE_MESSAGE_STATS_H
+#define NCCENTRIFUGE_MESSAGE_STATS_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include "elements/parameter.h"
+#ifdef WIN32
+	#include <map>
+#else
+	#include <tr1/unordered_map>
+	#include <boost/functional/hash.hpp>
+#endif
+
+namespace ncc {
+namespace controller {
+namespace message
+{
+    ///A histogram of durations.
+    ///
+    ///The first bucket holds durations up to a microsecond and each bucket 
+    ///after it is twice as wide as the one before, so a few buckets cover 
+    ///everything from microseconds to minutes. Adding a sample is cheap and 
+    ///never allocates.
+    class latency_histogram
+    {
+        public:
+            enum { bucket_count = 28 };
+
+            latency_histogram() { clear();}
+
+            ///Adds a duration in seconds.
+            void add(double seconds);
+
+            ///Removes all samples.
+            void clear();
+
+            ///Returns the number of samples.
+            unsigned long count() const { return samples;}
+
+            ///Returns the average duration in seconds.
+            double mean() const { return samples ? total / samples : 0;}
+
+            ///Returns the longest duration in seconds.
+            double max() const { return longest;}
+
+            ///Returns the number of samples in a bucket.
+            unsigned long bucket(unsigned int index) const { return index < bucket_count ? buckets[index] : 0;}
+
+            ///Returns the longest duration, in seconds, which goes in a bucket.
+            static double bucket_limit(unsigned int index);
+
+            ///Returns the duration which the fraction of samples specified 
+            ///do not exceed. 
+            ///
+            ///The result is the limit of the bucket holding the sample, so it
+            ///is within a factor of two of the real percentile.
+            ///@param fraction A value from 0 to 1, for example 0.99.
+            double percentile(double fraction) const;
+        private:
+            unsigned long buckets[bucket_count];
+            unsigned long samples;
+            double total;
+            double longest;
+    };
+
+    ///Counters kept by ncc::controller::message::manager.
+    ///
+    ///Statistics are only kept once enabled with 
+    ///ncc::controller::manager::enable_message_statistics, so that messaging 
+    ///costs nothing extra in scenes which are not being measured. Messages 
+    ///are counted by name. A message which is a string is named by the 
+    ///string, a typed message by the name it was registered for scripts 
+    ///with, and any other message by its type.
+    struct statistics
+    {
+        ///The counters of one call to send_messages.
+        struct frame
+        {
+            frame() { clear();}
+            void clear();
+            ///Adds the counters of another frame to this one.
+            frame& operator += (const frame& other);
+
+            unsigned long added;      ///< messages added since the last frame.
+            unsigned long posted;     ///< of those, posted from other threads.
+            unsigned long pending;    ///< messages waiting to be checked.
+            unsigned long scheduled;  ///< messages waiting in the schedule.
+            unsigned long checked;    ///< conditions checked.
+            unsigned long sent;       ///< messages delivered.
+            unsigned long dropped;    ///< messages erased because their 
+                                      ///< sender or recipient was gone.
+            unsigned long deliveries; ///< calls to handle_message.
+            unsigned long recipients; ///< controllers which were delivered a message.
+            unsigned long visited;    ///< index entries and tree nodes 
+                                      ///< visited to find recipients.
+            double seconds;           ///< time spent sending.
+        };
+
+        typedef std::pair<std::string, unsigned long> name_count;
+        typedef std::vector<name_count> name_count_list;
+
+        statistics() : frames(0), untyped(0) {}
+
+        ///Resets every counter.
+        void clear();
+
+        ///Returns the names of the messages sent the most, most first.
+        ///@param count The most names returned.
+        name_count_list top_messages(std::size_t count) const;
+
+        ///Writes a readable report.
+        ///@param top The number of message names listed.
+        void write(std::ostream& out, std::size_t top = 20) const;
+
+        ///Writes a readable report to a file.
+        ///@return False if the file could not be written.
+        bool dump(const std::string& file_name, std::size_t top = 20) const;
+
+        ///Counts a message sent with the name of the message.
+        void count_message(const parameter& message);
+
+        frame last;          ///< the counters of the last frame.
+        frame total;         ///< the counters of all frames.
+        unsigned long frames;
+        ///Time from when an unconditional message is added until it is 
+        ///delivered.
+        latency_histogram delivery_latency;
+        ///Time from when a conditional message is added until it is 
+        ///delivered.
+        latency_histogram condition_wait;
+
+#ifdef WIN32
+        typedef std::map<std::string, unsigned long> name_map;
+        typedef std::map<unsigned int, unsigned long> id_map;
+#else
+        typedef std::tr1::unordered_map<std::string, unsigned long, boost::hash<std::string> > name_map;
+        typedef std::tr1::unordered_map<unsigned int, unsigned long> id_map;
+#endif
+        ///Messages which are strings, counted by name.
+        name_map named;
+        ///Other messages, counted by parameter_id, and named only when a 
+        ///report is made.
+        id_map typed;
+        unsigned long untyped; ///< messages of a type without a parameter_id.
+    };
+}//namespace message
+}//namespace controller
+}//namespace ncc
+#endif
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+#ifndef NCCENTRIFUGE_TYPED_MESSAGE_H
+#define NCCENTRIFUGE_TYPED_MESSAGE_H
+
+#include <algorithm>
+#include <string>
+#include <boost/static_assert.hpp>
+#include "elements/parameter.h"
+#include "controller/controller_interface.h"
+
+///Gives a message struct a compile time id.
+///
+///Must be used at global scope, after the struct is declared and before 
+///it is sent in a message. Ids must be unique, greater than 0, and less 
+///than the size of the dispatch tables which handle the message.\n
+///Example:
+///     - struct damage { double amount; };
+///     - NCC_TYPED_MESSAGE(damage, 1)
+#define NCC_TYPED_MESSAGE(message_type, message_id) \
+    namespace ncc { \
+        template<> struct parameter_id<message_type> { enum { value = message_id }; }; \
+    }
+
+namespace ncc {
+namespace controller {
+namespace message
+{
+    ///Dispatches typed messages to the member functions of a controller.
+    ///
+    ///Instead of comparing the message against every message a controller 
+    ///knows, a dispatch table is indexed by the id of the message and calls 
+    ///the handler registered for it. The payload is passed to the handler 
+    ///as the struct it is, and a struct which fits in a parameter is sent 
+    ///without any allocation. The table is normally a static local of the 
+    ///controller's handle_message method.\n
+    ///Example:
+    ///     - void enemy::handle_message(const parameter& msg, const parameter_list& params, abstract_interface& from)
+    ///     - {
+    ///     -     static const message::dispatch_table<enemy> table = message::dispatch_table<enemy>()
+    ///     -         .handle<damage, &enemy::take_damage>()
+    ///     -         .handle<destroy, &enemy::destroy>();
+    ///     -     table.dispatch(*this, msg, from);
+    ///     - }
+    ///
+    ///Where take_damage is "void take_damage(const damage&, abstract_interface& from)".
+    ///Messages are sent as usual, for example 
+    ///"manager.send_message(this, "enemy", damage(20))".
+    ///@see NCC_TYPED_MESSAGE
+    template<class controller_type, unsigned int size = 64>
+        class dispatch_table
+        {
+            public:
+                dispatch_table() { std::fill(handlers, handlers + size, handler_type(0));}
+
+                ///Registers the member function which handles a message type.
+                template<class message_type, void (controller_type::*method)(const message_type&, abstract_interface&)>
+                    dispatch_table& handle()
+                    {
+                        BOOST_STATIC_ASSERT(parameter_id<message_type>::value > 0);
+                        BOOST_STATIC_ASSERT(parameter_id<message_type>::value < size);
+                        handlers[parameter_id<message_type>::value] = &call<message_type, method>;
+                        return *this;
+                    }
+
+                ///Calls the handler of the message.
+                ///@return False if the message is not typed or has no handler.
+                bool dispatch(controller_type& target, const parameter& message, abstract_interface& from) const
+                {
+                    const unsigned int id = message.id();
+                    if(id >= size || !handlers[id]) return false;
+                    return handlers[id](target, message, from);
+                }
+            private:
+                typedef bool (*handler_type)(controller_type&, const parameter&, abstract_interface&);
+
+                template<class message_type, void (controller_type::*method)(const message_type&, abstract_interface&)>
+                    static bool call(controller_type& target, const parameter& message, abstract_interface& from)
+                    {
+                        const message_type* typed = message.cast<message_type>();
+                        if(!typed) return false;
+                        (target.*method)(*typed, from);
+                        return true;
+                    }
+
+                handler_type handlers[size]; ///< indexed by message id.
+        };
+
+    ///Converts a typed message to the name and parameters a script sees.
+    typedef void (*to_script_function)(const parameter& message, parameter_list& params);
+
+    ///Creates a typed message from the parameters a script sent.
+    typedef bool (*from_script_function)(const parameter_list& params, parameter& message);
+
+    ///Registers the conversions of a typed message to and from scripts.
+    void register_script_message(unsigned int id, 
+            const std::string& name, 
+            to_script_function to_script, 
+            from_script_function from_script);
+
+    namespace hidden
+    {
+        template<class message_type>
+            void to_script(const parameter& message, parameter_list& params)
+            {
+                if(const message_type* typed = message.cast<message_type>()) 
+                    to_parameters(*typed, params);
+            }
+
+        template<class message_type>
+            bool from_script(const parameter_list& params, parameter& message)
+            {
+                message_type typed;
+                if(!from_parameters(params, typed)) return false;
+                message = typed;
+                return true;
+            }
+    }
+
+    ///Lets scripts send and receive a typed message.
+    ///
+    ///A script controller is sent the message as its name with the 
+    ///parameters made by "void to_parameters(const message_type&, parameter_list&)".
+    ///A message with the name sent by a script is turned into the typed 
+    ///message by "bool from_parameters(const parameter_list&, message_type&)".
+    ///Both functions must be declared by the user next to the message type.
+    ///@param name The name scripts use for the message.
+    template<class message_type>
+        void register_script_message(const std::string& name)
+        {
+            BOOST_STATIC_ASSERT(parameter_id<message_type>::value > 0);
+            register_script_message(parameter_id<message_type>::value, 
+                    name, 
+                    &hidden::to_script<message_type>,
+                    &hidden::from_script<message_type>);
+        }
+
+    ///Converts a typed message to a script message.
+    ///@return False if the message is not a typed message registered for 
+    ///scripts.
+    bool to_script(const parameter& message, std::string& name, parameter_list& params);
+
+    ///Gets the name a typed message was registered for scripts with.
+    ///@return False if no message with the id is registered.
+    bool script_name(unsigned int id, std::string& name);
+
+    ///Converts a script message to a typed message.
+    ///@param message The message sent by the script, normally a string.
+    ///@return False if the message does not name a typed message registered
+    ///for scripts or its parameters could not be converted.
+    bool from_script(const parameter& message, const parameter_list& params, parameter& typed);
+}//namespace message
+}//namespace controller
+}//namespace ncc
+#endif
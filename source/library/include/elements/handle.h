@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+#ifndef NCCENTRIFUGE_HANDLE_H
+#define NCCENTRIFUGE_HANDLE_H
+#include <cstddef>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+namespace ncc 
+{
+    ///A reference to an object in a handle_table.
+    ///
+    ///A handle is an index into the table and the generation of the slot at
+    ///that index when the handle was created. When the object is released 
+    ///the generation of the slot changes, so an old handle can never reach 
+    ///the object which later takes the slot. Unlike a pointer a handle 
+    ///cannot dangle, and unlike a weak_ptr checking it touches no reference
+    ///count. A default constructed handle is null.
+    class handle
+    {
+        public:
+            handle() : index(0), generation(0) {}
+            handle(boost::uint32_t slot_index, boost::uint32_t slot_generation) : 
+                index(slot_index), 
+                generation(slot_generation) {}
+
+            ///Returns the index of the slot in the table.
+            boost::uint32_t get_index() const {return index;}
+
+            ///Returns the generation of the slot the handle was created for.
+            boost::uint32_t get_generation() const {return generation;}
+
+            ///Returns the handle as one 64 bit value.
+            boost::uint64_t get_value() const {return (boost::uint64_t(generation) << 32) | index;}
+
+            ///Returns true if the handle refers to nothing.
+            bool is_null() const {return !index;}
+
+            bool operator == (const handle& rhs) const {return index == rhs.index && generation == rhs.generation;}
+            bool operator != (const handle& rhs) const {return !(*this == rhs);}
+            bool operator < (const handle& rhs) const {return get_value() < rhs.get_value();}
+        private:
+            boost::uint32_t index;
+            boost::uint32_t generation;
+    };
+
+    ///A table which hands out handles to objects.
+    ///
+    ///Looking up a handle is a bounds check, an array access, and a 
+    ///comparison of generations. Creating and releasing handles is lock 
+    ///free and can be done from any thread. The slots are allocated in 
+    ///chunks which never move, so a lookup can run at the same time as a 
+    ///handle is created. The table does not own the objects.
+    template<class type>
+        class handle_table : boost::noncopyable
+        {
+            public:
+                handle_table() : free_head(0), next_slot(1), count(0)
+                {
+                    for(std::size_t chunk = 0; chunk < max_chunks; ++chunk) chunks[chunk].store(0, boost::memory_order_relaxed);
+                }
+
+                ~handle_table()
+                {
+                    for(std::size_t chunk = 0; chunk < max_chunks; ++chunk) delete [] chunks[chunk].load(boost::memory_order_relaxed);
+                }
+
+                ///Creates a handle to the object.
+                ///@return A null handle if the table is full.
+                handle create(type* item)
+                {
+                    boost::uint32_t index = pop_free();
+                    if(!index) 
+                    {
+                        index = next_slot.fetch_add(1, boost::memory_order_relaxed);
+                        if(index >= max_chunks * chunk_size) return handle();
+                    }
+
+                    slot& entry = allocate_slot(index);
+                    entry.item.store(item, boost::memory_order_release);
+                    count.fetch_add(1, boost::memory_order_relaxed);
+                    return handle(index, entry.generation.load(boost::memory_order_relaxed));
+                }
+
+                ///Releases a handle so that it no longer refers to its object.
+                ///@return False if the handle was already released or is null.
+                bool release(const handle& value)
+                {
+                    slot* entry = find_slot(value.get_index());
+                    if(!entry) return false;
+
+                    //only one release of a handle changes the generation.
+                    boost::uint32_t generation = value.get_generation();
+                    if(!entry->generation.compare_exchange_strong(generation, generation + 1, boost::memory_order_acq_rel)) 
+                        return false;
+
+                    entry->item.store(0, boost::memory_order_release);
+                    push_free(value.get_index());
+                    count.fetch_sub(1, boost::memory_order_relaxed);
+                    return true;
+                }
+
+                ///Returns the object the handle refers to or 0 if the handle 
+                ///was released or is null.
+                type* get(const handle& value) const
+                {
+                    const slot* entry = find_slot(value.get_index());
+                    if(!entry || entry->generation.load(boost::memory_order_acquire) != value.get_generation()) return 0;
+                    return entry->item.load(boost::memory_order_acquire);
+                }
+
+                ///Returns true if the handle refers to an object.
+                bool is_valid(const handle& value) const {return get(value) != 0;}
+
+                ///Returns the number of handles which were not released.
+                std::size_t size() const {return count.load(boost::memory_order_relaxed);}
+            private:
+                enum { chunk_size = 4096, max_chunks = 1024 };
+
+                struct slot
+                {
+                    slot() : item(0), generation(0), next_free(0) {}
+                    boost::atomic<type*> item;
+                    boost::atomic<boost::uint32_t> generation;
+                    boost::atomic<boost::uint32_t> next_free; ///< the next slot in the free list.
+                };
+
+                slot* find_slot(boost::uint32_t index) const
+                {
+                    if(!index || index >= max_chunks * chunk_size) return 0;
+                    slot* chunk = chunks[index / chunk_size].load(boost::memory_order_acquire);
+                    return chunk ? chunk + index % chunk_size : 0;
+                }
+
+                slot& allocate_slot(boost::uint32_t index)
+                {
+                    boost::atomic<slot*>& chunk = chunks[index / chunk_size];
+                    slot* existing = chunk.load(boost::memory_order_acquire);
+                    if(!existing)
+                    {
+                        //another thread may add the chunk at the same time, 
+                        //in which case its chunk is used.
+                        slot* added = new slot[chunk_size];
+                        if(chunk.compare_exchange_strong(existing, added, boost::memory_order_acq_rel)) existing = added;
+                        else delete [] added;
+                    }
+                    return existing[index % chunk_size];
+                }
+
+                ///The free list is a stack of slot indices. Its head holds a 
+                ///tag in the upper 32 bits which changes on every push and 
+                ///pop so that a stale compare_exchange fails.
+                boost::uint32_t pop_free()
+                {
+                    boost::uint64_t head = free_head.load(boost::memory_order_acquire);
+                    while(boost::uint32_t index = boost::uint32_t(head))
+                    {
+                        const boost::uint64_t next = find_slot(index)->next_free.load(boost::memory_order_relaxed);
+                        const boost::uint64_t popped = (((head >> 32) + 1) << 32) | next;
+                        if(free_head.compare_exchange_weak(head, popped, boost::memory_order_acquire)) return index;
+                    }
+                    return 0;
+                }
+
+                void push_free(boost::uint32_t index)
+                {
+                    slot* entry = find_slot(index);
+                    boost::uint64_t head = free_head.load(boost::memory_order_relaxed);
+                    boost::uint64_t pushed;
+                    do
+                    {
+                        entry->next_free.store(boost::uint32_t(head), boost::memory_order_relaxed);
+                        pushed = (((head >> 32) + 1) << 32) | index;
+                    }
+                    while(!free_head.compare_exchange_weak(head, pushed, boost::memory_order_release));
+                }
+
+                boost::atomic<slot*> chunks[max_chunks];
+                boost::atomic<boost::uint64_t> free_head;
+                boost::atomic<boost::uint32_t> next_slot;
+                boost::atomic<std::size_t> count;
+        };
+} //namespace ncc
+#endif
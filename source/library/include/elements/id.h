@@ -31,6 +31,7 @@
 
 #ifndef NCCENTRIFUGE_ID_H
 #define NCCENTRIFUGE_ID_H
+#include <boost/atomic.hpp>
 namespace ncc 
 {
     ///A class that generates IDs for an object.
@@ -49,13 +50,14 @@ namespace ncc
 
             ///create a copy of an id_type
             ///
-            ///The copy constructor actually just creates a new id. The makes sure
-            ///that the id is unique in the application. 
-            id_type(const id_type&) {create_id();}
+            ///The copy has the same id, so ids can be passed and stored by 
+            ///value. An object which needs an id of its own, such as a 
+            ///recycled controller, is assigned a new id_type().
+            id_type(const id_type& other) : value(other.value) {}
             operator unsigned long() const {return value;}
 
             ///Assigns one id to the other
-            const id_type& operator = (const id_type& rhs) {create_id(); return *this;}
+            const id_type& operator = (const id_type& rhs) {value = rhs.value; return *this;}
 
             ///Returns the value of the id.
             unsigned long get_id() const {return value;}
@@ -74,16 +76,17 @@ namespace ncc
             bool operator != (const id_type& rhs) const {return value != rhs.value;}
 
         private:
-            void create_id() {value=previous_id;previous_id++;}
+            void create_id();
             ///Generates an id from the previous one. This is a simply the previous 
-            ///id plus one. 
-            static unsigned long previous_id;	///< this holds the previous id 
+            ///id plus one. It is atomic so that controllers can be created by
+            ///several threads during a parallel step.
+            static boost::atomic<unsigned long> previous_id;	///< this holds the previous id 
             ///value assigned.
             unsigned long value;	///< this holds the actual value of the id_type
 
     };
 
-    bool operator == (unsigned long lhs, id_type rhs);
+    bool operator == (unsigned long lhs, const id_type& rhs);
 } //namespace ncc
 #endif
 
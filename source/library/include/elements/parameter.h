@@ -32,16 +32,221 @@
 #ifndef NCCENTRIFUGE_PARAMETER_H
 #define NCCENTRIFUGE_PARAMETER_H
 
-#include <boost/any.hpp>
 #include <vector>
+#include <new>
+#include <cstddef>
+#include <algorithm>
+#include <typeinfo>
+#include <stdexcept>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/decay.hpp>
+#include <boost/type_traits/remove_cv.hpp>
 namespace ncc
 {
+    ///A compile time id of a type held by a parameter.
+    ///
+    ///A type is given an id by specializing this template, which 
+    ///NCC_TYPED_MESSAGE does for typed messages. Types without an id have 
+    ///the id 0. The id of the object a parameter holds is returned by 
+    ///parameter::id without looking at its type_info.
+    template<class type>
+        struct parameter_id
+        {
+            enum { value = 0 };
+        };
+
+    namespace detail
+    {
+        ///Inline storage of a parameter.
+        ///
+        ///Large enough to hold a std::string, vector_3dd, or quaterniond
+        ///without going to the heap. Objects which do not fit are allocated 
+        ///and the pointer is kept in heap.
+        union parameter_storage
+        {
+            char buffer[32];
+            void* heap;
+            double align_double;
+            long align_long;
+        };
+
+        ///The operations a parameter needs to perform on the object it holds.
+        ///There is one of these per stored type.
+        struct parameter_table
+        {
+            const std::type_info& (*type)();
+            void (*copy)(const parameter_storage& from, parameter_storage& to);
+            void (*destroy)(parameter_storage& storage);
+            const void* (*get)(const parameter_storage& storage);
+            unsigned int id;    ///< the parameter_id of the type.
+        };
+
+        ///Holds objects which fit in the inline storage.
+        template<class value_type, bool small>
+            struct parameter_holder
+            {
+                static void create(parameter_storage& storage, const value_type& value)
+                {
+                    new(storage.buffer) value_type(value);
+                }
+                static const std::type_info& type() { return typeid(value_type);}
+                static void copy(const parameter_storage& from, parameter_storage& to)
+                {
+                    create(to, *static_cast<const value_type*>(get(from)));
+                }
+                static void destroy(parameter_storage& storage)
+                {
+                    static_cast<value_type*>(static_cast<void*>(storage.buffer))->~value_type();
+                }
+                static const void* get(const parameter_storage& storage)
+                {
+                    return storage.buffer;
+                }
+                static const parameter_table table;
+            };
+
+        ///Holds objects which do not fit in the inline storage on the heap.
+        template<class value_type>
+            struct parameter_holder<value_type, false>
+            {
+                static void create(parameter_storage& storage, const value_type& value)
+                {
+                    storage.heap = new value_type(value);
+                }
+                static const std::type_info& type() { return typeid(value_type);}
+                static void copy(const parameter_storage& from, parameter_storage& to)
+                {
+                    create(to, *static_cast<const value_type*>(from.heap));
+                }
+                static void destroy(parameter_storage& storage)
+                {
+                    delete static_cast<value_type*>(storage.heap);
+                }
+                static const void* get(const parameter_storage& storage)
+                {
+                    return storage.heap;
+                }
+                static const parameter_table table;
+            };
+
+        template<class value_type, bool small>
+            const parameter_table parameter_holder<value_type, small>::table = 
+            {
+                &parameter_holder<value_type, small>::type,
+                &parameter_holder<value_type, small>::copy,
+                &parameter_holder<value_type, small>::destroy,
+                &parameter_holder<value_type, small>::get,
+                parameter_id<value_type>::value
+            };
+
+        template<class value_type>
+            const parameter_table parameter_holder<value_type, false>::table = 
+            {
+                &parameter_holder<value_type, false>::type,
+                &parameter_holder<value_type, false>::copy,
+                &parameter_holder<value_type, false>::destroy,
+                &parameter_holder<value_type, false>::get,
+                parameter_id<value_type>::value
+            };
+
+        ///Picks the holder for a type. Types are stored decayed like 
+        ///boost::any so that string literals are held as const char*.
+        template<class type>
+            struct parameter_traits
+            {
+                typedef typename boost::remove_cv<typename boost::decay<const type>::type>::type value_type;
+                static const bool small = 
+                    sizeof(value_type) <= sizeof(parameter_storage) &&
+                    boost::alignment_of<value_type>::value <= boost::alignment_of<parameter_storage>::value;
+                typedef parameter_holder<value_type, small> holder;
+            };
+    }//namespace detail
+
     ///A holder of any type.
     ///
     ///A holder of any type of object. This is used by the message system to 
-    ///send around arbitrary messages. This is simple a typedef of boost::any.
-    ///See http://www.boost.org for more documentation on boost::any.
-    typedef boost::any parameter;
+    ///send around arbitrary messages. It behaves like boost::any except that 
+    ///objects up to the size of a quaterniond, including std::string, are 
+    ///stored inline so the common parameters (numbers, strings, vectors, 
+    ///quaternions, and object or controller pointers) do not allocate.
+    ///Larger objects are held on the heap.
+    class parameter
+    {
+        public:
+            parameter() : table(0) {}
+            template<class type>
+                parameter(const type& value) : table(0)
+                {
+                    typedef typename detail::parameter_traits<type>::holder holder;
+                    holder::create(storage, value);
+                    table = &holder::table;
+                }
+            parameter(const parameter& other) : table(0)
+            {
+                if(other.table) other.table->copy(other.storage, storage);
+                table = other.table;
+            }
+            ~parameter() { clear();}
+
+            ///Assigns a copy of other.
+            ///
+            ///The copy is made before the object held is destroyed, since 
+            ///other may be part of it, such as a parameter in a 
+            ///parameter_list this parameter holds.
+            parameter& operator=(const parameter& other)
+            {
+                if(this != &other) assign(parameter(other));
+                return *this;
+            }
+            template<class type>
+                parameter& operator=(const type& value)
+                {
+                    assign(parameter(value));
+                    return *this;
+                }
+
+            ///Returns true if the parameter holds no object.
+            bool empty() const { return !table;}
+
+            ///Returns the type of the object held or typeid(void) if empty.
+            const std::type_info& type() const { return table ? table->type() : typeid(void);}
+
+            ///Returns the parameter_id of the object held or 0 if empty.
+            unsigned int id() const { return table ? table->id : 0;}
+
+            ///Destroys the object held, leaving the parameter empty.
+            void clear()
+            {
+                if(!table) return;
+                table->destroy(storage);
+                table = 0;
+            }
+
+            ///Returns a pointer to the object held if it is of the type 
+            ///specified, otherwise 0.
+            template<class type>
+                const type* cast() const
+                {
+                    typedef typename detail::parameter_traits<type>::holder holder;
+                    if(!table) return 0;
+                    //the type_info comparison covers tables instantiated 
+                    //in different modules.
+                    if(table != &holder::table && table->type() != typeid(type)) return 0;
+                    return static_cast<const type*>(table->get(storage));
+                }
+        private:
+            ///Replaces the object held with a copy of the one held by a 
+            ///parameter which is not part of it.
+            void assign(const parameter& copy)
+            {
+                clear();
+                if(copy.table) copy.table->copy(copy.storage, storage);
+                table = copy.table;
+            }
+
+            detail::parameter_storage storage;
+            const detail::parameter_table* table;
+    };
 
     ///A list of parameters
     ///
@@ -50,14 +255,184 @@ namespace ncc
     ///check for the amount of parameters to prevent any out of bounds problems. 
     ///The objects which the parameters hold can be easily extracted by using 
     ///ncc::get function.
+    ///\n\n
+    ///It behaves like a std::vector of parameters except that the first 
+    ///inline_capacity parameters are stored inside the list itself. Most 
+    ///messages have a few parameters, so creating and copying their 
+    ///parameter lists does not allocate.
     ///@see ncc::get
-    typedef std::vector<boost::any> parameter_list;
+    class parameter_list
+    {
+        public:
+            typedef parameter value_type;
+            typedef parameter& reference;
+            typedef const parameter& const_reference;
+            typedef parameter* iterator;
+            typedef const parameter* const_iterator;
+            typedef std::size_t size_type;
+            typedef std::ptrdiff_t difference_type;
+
+            ///The number of parameters held without allocating.
+            enum { inline_capacity = 4 };
+
+            parameter_list() : items(local()), count(0), reserved(inline_capacity) {}
+
+            ///Creates a list of n copies of a parameter.
+            explicit parameter_list(size_type n, const parameter& value = parameter()) : 
+                items(local()), count(0), reserved(inline_capacity)
+            {
+                reserve(n);
+                for(; count < n; ++count) new (items + count) parameter(value);
+            }
+
+            parameter_list(const parameter_list& other) : items(local()), count(0), reserved(inline_capacity)
+            {
+                reserve(other.count);
+                for(; count < other.count; ++count) new (items + count) parameter(other.items[count]);
+            }
+
+            ~parameter_list() 
+            { 
+                clear();
+                release();
+            }
+
+            parameter_list& operator=(const parameter_list& other)
+            {
+                if(this == &other) return *this;
+                //other may be held by one of the parameters, so it is 
+                //copied before they are destroyed.
+                const parameter_list copy(other);
+                clear();
+                reserve(copy.count);
+                for(; count < copy.count; ++count) new (items + count) parameter(copy.items[count]);
+                return *this;
+            }
+
+            ///Exchanges the parameters of two lists.
+            ///
+            ///Lists which both allocated exchange their storage without 
+            ///copying any parameter.
+            void swap(parameter_list& other)
+            {
+                if(items != local() && other.items != other.local())
+                {
+                    std::swap(items, other.items);
+                    std::swap(count, other.count);
+                    std::swap(reserved, other.reserved);
+                    return;
+                }
+                parameter_list held(*this);
+                *this = other;
+                other = held;
+            }
+
+            ///Adds a parameter holding the value to the end of the list.
+            ///
+            ///The parameter is created in place, so the value is not first 
+            ///put in a temporary parameter.
+            template<class type>
+                void push_back(const type& value)
+                {
+                    if(count == reserved) 
+                    {
+                        //the value may be in the list so it is copied 
+                        //before the old parameters are destroyed.
+                        parameter* grown = static_cast<parameter*>(::operator new(reserved * 2 * sizeof(parameter)));
+                        new (grown + count) parameter(value);
+                        relocate(grown, reserved * 2);
+                    }
+                    else new (items + count) parameter(value);
+                    ++count;
+                }
+
+            ///Removes the last parameter.
+            void pop_back() { items[--count].~parameter();}
+
+            ///Makes room for n parameters.
+            void reserve(size_type n)
+            {
+                if(n <= reserved) return;
+
+                relocate(static_cast<parameter*>(::operator new(n * sizeof(parameter))), n);
+            }
+
+            ///Changes the number of parameters, adding copies of value if 
+            ///the list grows.
+            void resize(size_type n, const parameter& value = parameter())
+            {
+                while(count > n) pop_back();
+                reserve(n);
+                for(; count < n; ++count) new (items + count) parameter(value);
+            }
+
+            ///Removes every parameter. The storage is kept.
+            void clear() { while(count) pop_back();}
+
+            size_type size() const { return count;}
+            size_type capacity() const { return reserved;}
+            bool empty() const { return !count;}
+
+            parameter& operator[](size_type index) { return items[index];}
+            const parameter& operator[](size_type index) const { return items[index];}
+            ///Like operator[] but throws std::out_of_range if index is not
+            ///less than size().
+            parameter& at(size_type index) { check_index(index); return items[index];}
+            const parameter& at(size_type index) const { check_index(index); return items[index];}
+            parameter& front() { return items[0];}
+            const parameter& front() const { return items[0];}
+            parameter& back() { return items[count - 1];}
+            const parameter& back() const { return items[count - 1];}
+
+            iterator begin() { return items;}
+            iterator end() { return items + count;}
+            const_iterator begin() const { return items;}
+            const_iterator end() const { return items + count;}
+        private:
+            void check_index(size_type index) const
+            {
+                if(index >= count) throw std::out_of_range("ncc::parameter_list::at");
+            }
+            parameter* local() { return reinterpret_cast<parameter*>(buffer.bytes);}
+            const parameter* local() const { return reinterpret_cast<const parameter*>(buffer.bytes);}
+
+            ///Moves the parameters to new storage of n parameters.
+            void relocate(parameter* grown, size_type n)
+            {
+                for(size_type index = 0; index < count; ++index)
+                {
+                    new (grown + index) parameter(items[index]);
+                    items[index].~parameter();
+                }
+                release();
+                items = grown;
+                reserved = n;
+            }
+
+            ///Frees the allocated storage, if any. The parameters must 
+            ///already be destroyed.
+            void release()
+            {
+                if(items != local()) ::operator delete(items);
+                items = local();
+                reserved = inline_capacity;
+            }
+
+            union
+            {
+                char bytes[inline_capacity * sizeof(parameter)];
+                detail::parameter_storage align;
+            } buffer;
+            parameter* items;   ///< points to buffer until the list allocates.
+            size_type count;
+            size_type reserved;
+    };
 
     ///Returns true if a parameter holds an object of a certain type.
     template <class type>
         bool is_type(const parameter & operand)
         {
-            return boost::any_cast<type>(&operand);
+            return operand.cast<type>();
         }
 
 
@@ -80,7 +455,7 @@ namespace ncc
     template <class type>
         bool get(const parameter& operand, type& result)
         {
-            if(const type* held = boost::any_cast<type>(&operand)) 
+            if(const type* held = operand.cast<type>()) 
             {
                 result = *held; 
                 return true;
@@ -103,7 +478,7 @@ namespace ncc
     template<class type>
         type get (const parameter& operand)
         {
-            if(const type* held = boost::any_cast<type>(&operand))		
+            if(const type* held = operand.cast<type>())		
                 return *held;				
             else	
                 return type();		
@@ -33,16 +33,25 @@
 #define NCCENTRIFUGE_TREE_H
 
 #include <algorithm>
-#include <list>
+#include <vector>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 namespace ncc {
 namespace tree
 {
+    namespace hidden
+    {
+        template <class node_type, class predicate>
+            void remove_if(node_type& root, predicate& should_remove);
+    }
+
     ///Allows any class to become a node to a tree structure. 
     ///
     ///Inherent this class to turn your class into a node in a tree structure. 
+    ///The children of a node are kept in a contiguous array so that 
+    ///walking the tree does not chase a pointer for every child. Children 
+    ///added while the tree is being walked are visited by the same walk.
     ///Example:
     ///		- class MyClass : public ncc::is_node<MyClass>
     template <typename data_type>
@@ -52,7 +61,7 @@ namespace tree
             typedef boost::shared_ptr<data_type> node_type;
             typedef boost::shared_ptr<data_type const> const_node_type;
             typedef boost::weak_ptr<data_type> observer_node_type;
-            typedef std::list<node_type> child_list_type;
+            typedef std::vector<node_type> child_list_type;
             typedef typename child_list_type::iterator child_iterator;
             typedef typename child_list_type::const_iterator const_child_iterator;
             typedef typename child_list_type::size_type child_size_type;
@@ -101,13 +110,17 @@ namespace tree
             ///Returns the end interator to the children.
             ///@{
             child_iterator children_end() { return child_list.end();}
-            const_child_iterator children_end() const {return child_list.begin();}
+            const_child_iterator children_end() const {return child_list.end();}
             ///@}
 
             ///Returns the number of children.
             child_size_type children_size() const {return child_list.size();}
 
         private:
+            //remove_if resets the parent of the children it removes.
+            template <class node_type, class predicate>
+                friend void hidden::remove_if(node_type& root, predicate& should_remove);
+
             data_type* parent_ptr;
             data_type* this_ptr;
             child_list_type child_list;
@@ -118,9 +131,13 @@ namespace tree
         is_node<data_type>::add_child(typename is_node::node_type new_child)
         {
             if(!new_child) return false;
-            //make sure that the pointer does not exist already
-            typename child_list_type::const_iterator child_exists = std::find(child_list.begin(), child_list.end(), new_child);
-            if(child_exists != child_list.end()) return false; 		
+            //make sure that the pointer does not exist already. A node can 
+            //only be our child if its parent is us so the search is only 
+            //needed then. Removing a child resets its parent, so a node 
+            //which was removed is not mistaken for a child.
+            if(new_child->parent_ptr == this_ptr && 
+                    std::find(child_list.begin(), child_list.end(), new_child) != child_list.end()) 
+                return false;
 
             child_list.push_back(new_child);
             new_child->parent_ptr = this_ptr;	
@@ -130,14 +147,12 @@ namespace tree
         bool 
         is_node<data_type>::remove_child(typename is_node::node_type target_child)
         {
-            //I could have used child_list_type_list.remove(target_child)
-            //but then I could not return a boolean if the child was removed or not.
-            //because std::list::remove returns void.
-            //so we will do it the classic way and find the target_child and remove it using erase.
-            //note that because add_child guarantees that there is no duplicate child.
+            //find the target_child and remove it using erase.
+            //note that add_child guarantees that there is no duplicate child.
             typename child_list_type::iterator target = std::find(child_list.begin(), child_list.end(), target_child);
             if(target != child_list.end()) 
             {
+                if((*target)->parent_ptr == this_ptr) (*target)->parent_ptr = 0;
                 child_list.erase(target);
                 return true;
             }
@@ -155,9 +170,9 @@ namespace tree
                 //predicate then we found it and 
                 //return the root.
                 //for each unvisited child we search again.
-                typename node_type::element_type::child_iterator end = root->children_end();
-                for(typename node_type::element_type::child_iterator child = root->children_begin(); child != end; ++child)
-                    if(node_type found_node = hidden::depth_first_search(*child, predicate))
+                typename node_type::element_type::child_list_type& children = root->children();
+                for(typename node_type::element_type::child_size_type child = 0; child < children.size(); ++child)
+                    if(node_type found_node = hidden::depth_first_search(children[child], predicate))
                         return found_node;
                 return node_type();
             }
@@ -170,10 +185,15 @@ namespace tree
                 //do anything.
                 if(visit(root) == false) return; //if visit returns false then the 
                 //children are not visited.                            
-                //visit each child if it has not been visited
-                typename node_type::element_type::child_iterator end = root->children_end();
-                for(typename node_type::element_type::child_iterator child = root->children_begin(); child != end; ++child)
-                    hidden::transverse_depth_first(*child, visit);
+                //visit each child if it has not been visited. Indices are used 
+                //and each child is copied before it is visited because a visit
+                //may add children, which can move the array.
+                typename node_type::element_type::child_list_type& children = root->children();
+                for(typename node_type::element_type::child_size_type child = 0; child < children.size(); ++child)
+                {
+                    node_type next = children[child];
+                    hidden::transverse_depth_first(next, visit);
+                }
             }
 
         template <class node_type, class predicate>
@@ -182,18 +202,23 @@ namespace tree
             {
                 if(!root) return; //if we have a null pointer then return and don't
                 //do anything
-                //visit each child if it has not been visited
-                typename node_type::element_type::child_iterator end = root->children_end();
-                for(typename node_type::element_type::child_iterator child = root->children_begin(); child != end ;)
+                //the children that are kept are moved to the front in a single 
+                //pass and the rest are erased at the end, instead of erasing 
+                //them one at a time.
+                typename node_type::element_type::child_list_type& children = root->children();
+                typename node_type::element_type::child_size_type kept = 0;
+                for(typename node_type::element_type::child_size_type child = 0; child < children.size(); ++child)
                 {
-                    if(should_remove(*child))
+                    if(should_remove(children[child]))
                     {
-                        child = root->children().erase(child); continue;
+                        if(children[child]->parent_ptr == root.get()) children[child]->parent_ptr = 0;
+                        continue;
                     }
-                    else
-                        hidden::remove_if(*child, should_remove);
-                    ++child;
+                    hidden::remove_if(children[child], should_remove);
+                    if(kept != child) children[kept].swap(children[child]);
+                    ++kept;
                 }
+                children.erase(children.begin() + kept, children.end());
             }//remove_if
     }//namespace hidden
 
@@ -110,18 +110,34 @@ namespace object
     ///     - void get_orientation(double& x, double& y, double& z, double& w)
     ///     - void get_position(double& x, double& y, double& z) 
     ///     - void update() 
+    ///     - bool needs_sync() const
+    ///     - void synced()
+    ///     - bool is_thread_safe() const
     ///     - virtual void set_mass(double x)
     ///     - virtual double get_mass() const
     ///     - virtual void set_bounce(double bounce) 
     ///     - virtual double get_bounce() const 
     ///     - virtual void set_friction(double friction)
     ///     - virtual double get_friction() const 
+    ///
+    ///\n\n
+    ///needs_sync returns true if the physical body may have moved since the 
+    ///last call to synced. The physical body is only updated and copied to 
+    ///the visual body when it does, so sleeping and static objects cost 
+    ///nothing but that check.
+    ///
+    ///is_thread_safe returns true if the update of the physical body only 
+    ///changes the body itself. Such bodies are updated and read by 
+    ///update_physical on the threads of a parallel step. The others, such as
+    ///a trimesh which moves its ODE geom, are updated by update on the thread
+    ///which calls step.
     ///@ingroup objects
     template <class visual_body, class physical_body>  
         class object : public abstract_interface, public visual_body, public physical_body
     {
         public:
             virtual void update();
+            virtual void update_physical();
             virtual void add_force(double x, double y, double z) { physical_body::add_force(x, y, z);}
             virtual void add_torque(double x, double y, double z) {physical_body::add_torque(x, y, z);}
             virtual void add_relative_force(double x, double y, double z) { physical_body::add_relative_force(x, y, z);}
@@ -140,28 +156,62 @@ namespace object
             virtual void set_friction(double friction) {physical_body::set_friction(friction);}
             virtual double get_friction() const {return physical_body::get_friction();}
 
-            object(): visual_body(), physical_body(), abstract_interface() {}        
+            object(): visual_body(), physical_body(), abstract_interface(), pending_sync(false), physical_updated(false) {}        
+        private:
+            ///Updates the physical body and reads its transform if it moved.
+            void sync_physical();
+
+            //the transform read by sync_physical for the visual body.
+            double synced_position[3];
+            double synced_orientation[4];
+            bool pending_sync;
+            bool physical_updated; ///< true if update_physical already ran for the next update.
     };
 
     template <class visual_body, class physical_body> 
         void 
         object<visual_body, physical_body>::update()
         {
-            //update the physical body
-            physical_body::update();
-            //get the physical body orientation and update the visual body orientation
-            double quat[4];
-            physical_body::get_orientation(quat[0], quat[1], quat[2], quat[3]);
-            visual_body::update_orientation(quat[0], quat[1], quat[2], quat[3]);
+            if(!physical_updated) sync_physical();
+            physical_updated = false;
 
-            //get the physical body position and update the visual body position
-            physical_body::get_position(quat[0], quat[1], quat[2]);
-            visual_body::update_position(quat[0], quat[1], quat[2]);
+            if(pending_sync)
+            {
+                visual_body::update_orientation(synced_orientation[0], synced_orientation[1], synced_orientation[2], synced_orientation[3]);
+                visual_body::update_position(synced_position[0], synced_position[1], synced_position[2]);
+                pending_sync = false;
+            }
 
             //update the visual body
             visual_body::update();
         }
 
+    template <class visual_body, class physical_body> 
+        void 
+        object<visual_body, physical_body>::update_physical()
+        {
+            //a body which changes more than itself is left for update.
+            if(!physical_body::is_thread_safe()) return;
+            sync_physical();
+            physical_updated = true;
+        }
+
+    template <class visual_body, class physical_body> 
+        void 
+        object<visual_body, physical_body>::sync_physical()
+        {
+            //a sleeping or static physical body has not moved since the last
+            //update so there is nothing to copy to the visual body.
+            if(!physical_body::needs_sync()) return;
+
+            //update the physical body
+            physical_body::update();
+            physical_body::get_orientation(synced_orientation[0], synced_orientation[1], synced_orientation[2], synced_orientation[3]);
+            physical_body::get_position(synced_position[0], synced_position[1], synced_position[2]);
+            physical_body::synced();
+            pending_sync = true;
+        }
+
     template <class list>
         void update_objects(list& objects)
         {
@@ -37,9 +37,13 @@
 #include <boost/weak_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include "elements/id.h"
+#include "elements/handle.h"
 namespace ncc {
 namespace object
 {
+    //forward declaration
+    class manager;
+
     ///An abstract_interface class for general 3d object control
     ///
     ///All physical objects in a 3d enviornment will have this abstract_interface.
@@ -56,6 +60,17 @@ namespace object
             ///an object or animation. 
             virtual void update() = 0;
 
+            ///Reads the state the next update needs.
+            ///
+            ///When the object manager steps in parallel this method is called
+            ///first, on many threads at once, and must only change the object
+            ///itself. update is called afterwards on the thread which called 
+            ///step and may change the scene graph or the physics world. The 
+            ///default does nothing, so that all of the update happens in 
+            ///update.
+            ///@see ncc::object::manager::enable_parallel_step
+            virtual void update_physical() {}
+
             ///Adds force in world space to the object
             ///
             ///This will add a force to the center of mass of an object in world 
@@ -141,7 +156,7 @@ namespace object
             ///Returns the friction of the objects surface
             virtual double get_friction() const = 0;
 
-            abstract_interface() : id_type() {}
+            abstract_interface() : id_type(), manager_index(0), owner(0) {}
             virtual ~abstract_interface(){}
 
             const std::string& get_name() const { return name;}
@@ -149,9 +164,22 @@ namespace object
 
             const int& get_id() const { return id_value;}
             void set_id(const int& value) { id_value = value;}
+
+            ///Returns the handle of the object in the object manager.
+            ///
+            ///The handle is null until the object is added to an 
+            ///object::manager and becomes invalid when it is removed.
+            ///@see ncc::object::manager::get_object
+            const handle& get_handle() const { return handle_holder;}
         private:
+            //Give the manager access to the handle.
+            friend class manager;
+
             std::string name;
             int id_value;
+            handle handle_holder;
+            std::size_t manager_index; ///< The position in the manager's array.
+            manager* owner; ///< The manager the object is in, 0 if none.
     };
 
     typedef boost::shared_ptr<abstract_interface> ptr;
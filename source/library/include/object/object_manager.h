@@ -32,14 +32,18 @@
 #ifndef NCCENTRIFUGE_OBJECT_MANAGER_H
 #define NCCENTRIFUGE_OBJECT_MANAGER_H
 #include <algorithm>
-#include <set>
-#include <map>
+#include <vector>
 #include <boost/utility.hpp>
+#include <boost/scoped_ptr.hpp>
 #include "object/object_interface.h"
+#include "elements/handle.h"
+#include "utilities/thread_pool.h"
 namespace ncc {
 namespace object 
 {
-    typedef std::set<ptr> object_set;
+    ///The objects are kept packed in an array so that stepping them walks
+    ///contiguous memory.
+    typedef std::vector<ptr> object_array;
     ///Manages 3d objects.
     ///
     ///The advantage of using the object manager is that all objects
@@ -58,41 +62,97 @@ namespace object
             ///point to the object is returned. It is recommened you hold a 
             ///weak_ptr instead of the shared_ptr so that delocation of an object
             ///is predictable.
+            ///\n\n
+            ///An object can only be in one manager at a time. Adding an object
+            ///which is in another manager does nothing and returns an empty 
+            ///weak_ptr. An object removed during step can be added again in 
+            ///the same step.
             weak_ptr add_object(ptr object_ptr);
 
             ///Removes a specific object from the object manager.
             ///
             ///It is important to node that the weak_ptr to the object will not be 
-            ///valid after this call.
+            ///valid after this call. Removal takes constant time. The last 
+            ///object of the array takes the place of the removed one, so the
+            ///order of the objects changes. An object removed during step is
+            ///not updated again and leaves the array when the step is over.
             //@{
             void remove_object(weak_ptr& object);
             void remove_object(abstract_interface* object_ptr);
+            void remove_object(const handle& object);
             //@}
 
+            ///Returns the object a handle refers to.
+            ///
+            ///The lookup is an array access and touches no reference count.
+            ///@return The object or 0 if it was removed.
+            abstract_interface* get_object(const handle& object) const { return handles.get(object);}
+
 
             ///Returns the begining iterator of the object list.
             ///@{
-            object_set::const_iterator begin() const { return objects.begin();}
-            object_set::iterator begin() { return objects.begin();}
+            object_array::const_iterator begin() const { return objects.begin();}
+            object_array::iterator begin() { return objects.begin();}
             ////@}
 
             ///Returns the end iterator of the object list
             ///@{
-            object_set::const_iterator end() const {return objects.end();}
-            object_set::iterator end() {return objects.end();}
+            object_array::const_iterator end() const {return objects.end();}
+            object_array::iterator end() {return objects.end();}
             ///@}
 
             ///Returns the amount of objects being managed.
-            object_set::size_type size() const {return objects.size();}
+            object_array::size_type size() const {return objects.size();}
 
             ///Updates every managed object.
             ///
             ///The all objects update methods are called.
             void step();
 
-            manager(){}
+            ///Makes step update the objects in parallel.
+            ///
+            ///The object array is split in ranges which a work stealing 
+            ///thread pool runs through, calling update_physical on each 
+            ///object. Then update is called on every object from the thread 
+            ///calling step, so that the scene graph and the physics world are
+            ///only changed from one thread.
+            ///@param threads The number of threads to use, counting the one
+            ///calling step. If 0 then the number of hardware threads is used.
+            ///@see ncc::object::abstract_interface::update_physical
+            void enable_parallel_step(unsigned int threads = 0);
+
+            ///Makes step update every object on the calling thread.
+            void disable_parallel_step();
+
+            manager() : stepping(false) {}
+            ~manager();
         private:
-            object_set objects;
+            ///Calls update_physical on the objects from begin up to end.
+            void update_physical(std::size_t begin, std::size_t end);
+
+            ///Takes the object at index out of the array.
+            void erase_object(std::size_t index);
+
+            ///Erases the objects removed during step.
+            void erase_removed_objects();
+
+            ///Returns true if the object at index was not removed during 
+            ///step.
+            bool is_stepped(std::size_t index) const
+            {
+                return handles.get(objects[index]->handle_holder) != 0;
+            }
+
+            ///Returns true if the object is in the array, which an object 
+            ///removed during step still is until the step is over.
+            bool is_managed(const abstract_interface* object) const { return object->owner == this;}
+
+            object_array objects;
+            handle_table<abstract_interface> handles;
+            boost::scoped_ptr<thread_pool> pool; ///< 0 unless stepping in parallel.
+            thread_pool::task_list range_tasks;
+            bool stepping; ///< true while step updates the objects.
+            std::vector<std::size_t> removed_objects; ///< indices of the objects removed during step.
     };
 }//namesepace object
 }//namespace ncc
@@ -47,6 +47,11 @@ namespace object
             ghost(const ghost& other) : position(other.position), velocity(other.velocity), orientation(other.orientation) {}
             void create_physical_body(double x, double y, double z);
             void update();
+            ///A ghost moves every step so it always needs to be synced.
+            bool needs_sync() const {return true;}
+            void synced() {}
+            ///A ghost only changes itself when it is updated.
+            bool is_thread_safe() const {return true;}
             void add_force(double x, double y, double z);
             void add_torque(double x, double y, double z);
             void add_relative_force(double x, double y, double z);
@@ -33,6 +33,9 @@
 #define NCCENTRIFUGE_ODE_MANAGER_H
 
 #include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
 #include <boost/utility.hpp>
 #include <boost/shared_array.hpp>
 #include <ode/ode.h>
@@ -55,15 +58,120 @@ namespace ode
     typedef cache<trimesh_data> trimesh_data_cache;
     class object;
 
+    ///Describes a collision to a collision callback.
+    ///
+    ///The contact data is taken from the deepest contact of the pair.
     struct collision_info
     {
-        double depth;
-        ncc::object::abstract_interface* object_1;
-        ncc::object::abstract_interface* object_2;
+        double depth; ///< How deep the objects are in each other.
+        ncc::object::abstract_interface* object_1; ///< The object whose 
+        ///callback is called, 0 if it is not an ncc::object::abstract_interface.
+        ncc::object::abstract_interface* object_2; ///< The object it 
+        ///collided with.
+        ///Whether the objects started touching on this step, still touch, 
+        ///or stopped touching. The contact data of an ended collision is 
+        ///the one of the last step they touched.
+        enum collision_state {contact_begin, contact_persist, contact_end} state;
+        double position[3]; ///< The contact point in world space.
+        double normal[3]; ///< Moving object_1 along the normal by depth 
+        ///separates the objects.
+        double relative_speed; ///< The speed at which the objects move 
+        ///towards each other along the normal.
     };
 
     typedef boost::function<bool (const collision_info)> collision_callback;
 
+    ///Identifies a material of the ncc::ode::manager.
+    typedef std::size_t material_id;
+
+    ///What the collision callback needs to know about a geom.
+    ///
+    ///ncc::ode::object keeps one and stores a pointer to it in the data of 
+    ///its geom, so that the collision callback gets to the object, its 
+    ///interface, and its material without virtual calls or casts.
+    struct geom_data
+    {
+        object* owner;
+        ncc::object::abstract_interface* object_interface; ///< 0 if the 
+        ///owner is not an ncc::object::abstract_interface.
+        material_id material;
+        bool solid; ///< False if the owner gets no contact joints.
+    };
+
+    ///A ray of a batched ray cast.
+    struct ray_query
+    {
+        double origin[3];
+        double direction[3];
+        double length;
+    };
+
+    ///What a ray cast or an overlap query found.
+    struct query_hit
+    {
+        object* hit_object; ///< 0 if nothing was hit.
+        ncc::object::abstract_interface* object_interface; ///< 0 if nothing
+        ///was hit or the object is not an ncc::object::abstract_interface.
+        double depth; ///< For a ray the distance from its origin to the hit,
+        ///for an overlap how deep the shapes overlap.
+        double position[3]; ///< The contact point in world space.
+        double normal[3]; ///< The surface normal at the contact point.
+    };
+
+    typedef std::vector<ray_query> ray_query_list;
+    typedef std::vector<query_hit> query_hit_list;
+
+    ///Describes the broadphase space of an ncc::ode::manager.
+    ///
+    ///The broadphase finds the pairs of geoms which are close enough to 
+    ///be tested for collision. The spaces are:
+    ///     - simple tests every pair.
+    ///     - hash puts geoms in grid cells of sizes 2^min_level up to 
+    ///       2^max_level.
+    ///     - quadtree splits the bounds of the world depth times. Geoms 
+    ///       outside the bounds are kept in the top cell.
+    ///     - sweep_and_prune sorts the geoms along the axes.
+    ///
+    ///Which one is fastest depends on the scene. broadphase_benchmark in 
+    ///tests/linux reports the pairs tested and the time of a collision pass
+    ///of each space for a scene, and can be adapted to a game's levels.
+    ///
+    ///The default is the quadtree which the manager always used.
+    struct space_settings
+    {
+        enum space_type {simple, hash, quadtree, sweep_and_prune} type;
+        int min_level; ///< The smallest hash cell is 2^min_level.
+        int max_level; ///< The largest hash cell is 2^max_level.
+        double center[3]; ///< The center of the quadtree.
+        double extents[3]; ///< The size of the quadtree.
+        int depth; ///< The levels of the quadtree.
+
+        space_settings(space_type space = quadtree) : 
+            type(space), min_level(-1), max_level(5), depth(10)
+        {
+            center[0] = center[1] = center[2] = 0;
+            extents[0] = extents[1] = extents[2] = 500;
+        }
+
+        ///Returns settings sized to the bounds of a level.
+        ///
+        ///The quadtree is made to cover the bounds, with as many levels, up
+        ///to 10, as it takes for its smallest cells to be about cell_size 
+        ///wide. The hash cells range from cell_size to the size of the 
+        ///bounds.
+        ///@param cell_size The size of a typical object.
+        static space_settings fit(space_type space, 
+                double min_x, double min_y, double min_z, 
+                double max_x, double max_y, double max_z,
+                double cell_size = 1.0);
+    };
+
+    ///The ODE near callback which creates the contact joints.
+    ///
+    ///It is used by ncc::ode::manager::step and is passed to dSpaceCollide 
+    ///with the manager as the data pointer.
+    void near_callback(void* mgr, dGeomID o1, dGeomID o2);
+
     ///Manages ODE physics objects. 
     ///
     ///Manages various aspects of objects using the ODE library. All objects
@@ -77,7 +185,9 @@ namespace ode
             ///used by ncc::ode::trimesh.
             typedef boost::shared_ptr<trimesh_data> trimesh_data_ptr; 
 
-            manager(double erp= 0.2, double cfm = 1e-5);
+            ///Creates the ODE world and the broadphase space.
+            ///@param space The broadphase to use. @see ncc::ode::space_settings
+            manager(double erp= 0.2, double cfm = 1e-5, const space_settings& space = space_settings());
             ~manager();
 
             ///Steps the physics simulation by a certain timestep
@@ -85,23 +195,130 @@ namespace ode
             ///This method steps the physics simulation by a certain timestep. 
             ///The smaller the timestep the more accurate the physics 
             ///simulation...but the more slow the physics.
+            ///\n\n
+            ///The collisions of objects with collision callbacks are recorded
+            ///while the space is collided and the callbacks are called once 
+            ///per pair after the world was stepped, with the state of the 
+            ///collision. Whether contact joints are created is decided while 
+            ///colliding: no joints are created for a pair if one of the 
+            ///objects is not solid, which is what a trigger or a bullet which
+            ///must pass through from the first contact should use. If the 
+            ///callbacks of a pair return false then no contact joints are 
+            ///created for the pair from the next step on, until the objects 
+            ///stop touching. @see ncc::ode::object::set_solid
             void step(double step_size);
 
+            ///Forgets the collisions recorded for a geom.
+            ///
+            ///ncc::ode::object calls this when it is destroyed so that no 
+            ///callback is called with it afterwards.
+            void forget_collisions(const geom_data* geom);
+
+            ///Forgets the collisions recorded since the last step.
+            ///
+            ///Only needed when the space is collided with near_callback 
+            ///outside of step, such as by a benchmark, which would otherwise
+            ///deliver the collisions on the next step.
+            void clear_collisions();
+
             ///Sets the gravity vector for the physics world.
             void set_gravity(double x, double y, double z) { dWorldSetGravity (world_id, x ,y,z);}      
 
-            ///Returns the ode space all objects are in.
+            ///Returns the ode space the objects with rigid bodies are in.
             dSpaceID ode_space() { return space_id;}
 
+            ///Returns the ode space of static objects.
+            ///
+            ///Objects with a mass of 0, such as the level and walls, are kept 
+            ///in their own space which is only collided against the space of 
+            ///the rigid bodies, so pairs of static objects are never tested.
+            dSpaceID ode_static_space() { return static_space_id;}
+
             ///Returns the ode world all objects are in.
             dWorldID ode_world() { return world_id;}
 
             ///Returns the ode contact group to use with collision.
             dJointGroupID contact_group() { return contact_group_id;}
 
+            ///Returns the material with the friction and bounce.
+            ///
+            ///Objects with the same friction and bounce share a material. The
+            ///surfaces of the first max_table_materials materials are kept in
+            ///a table so that collisions only have to look them up, the 
+            ///surfaces of later materials are computed on every collision. A 
+            ///game should therefore use a small set of friction and bounce 
+            ///values.
+            ///\n\n
+            ///Each call adds a use of the material which is ended with 
+            ///release_material. ncc::ode::object does this when its friction 
+            ///or bounce change and when it is destroyed.
+            material_id get_material(double friction, double bounce);
+
+            ///Ends a use of a material returned by get_material.
+            ///
+            ///A material which is no longer used is removed, along with the 
+            ///surfaces set for it, and its id is given to the next new 
+            ///material.
+            void release_material(material_id material);
+
+            ///Sets the friction and bounce used when two materials touch.
+            ///
+            ///By default the friction of a pair is the geometric mean of the 
+            ///frictions of the materials and the bounce is the average of 
+            ///their bounces.
+            void set_material_pair(material_id first, material_id second, double friction, double bounce);
+
+            ///Returns the contact surface used when two materials touch.
+            dSurfaceParameters get_surface(material_id first, material_id second) const 
+            { 
+                if(first < table_width && second < table_width) return surfaces[first * table_width + second];
+                return pair_surface(first, second);
+            }
+
+            ///The most materials whose surfaces are kept in the table.
+            enum { max_table_materials = 64 };
+
+            ///Casts a ray and returns the distance to the closest object hit.
+            ///
+            ///The object hit is put in obj, 0 if there is none, in which case 
+            ///1e10 is returned.
             double ray_cast(double origin_x, double origin_y, double origin_z, 
                     double direction_x, double direction_y, double direction_z, 
                     double length, ode::object** obj);
+
+            ///How a ray cast picks the object it hits.
+            enum query_mode 
+            {
+                closest_hit, ///< The object closest to the origin of the ray.
+                any_hit ///< The first object found, enough for line of sight.
+            };
+
+            ///Casts a batch of rays.
+            ///
+            ///The manager keeps one ray geom which it reuses for every ray, 
+            ///so nothing is created or destroyed per ray. Each ray is tested 
+            ///against the rigid bodies and the static objects.
+            ///@param hits Is resized to the number of rays and gets the hit 
+            ///of each ray, in the order of the rays.
+            ///@param mask The collision categories the rays hit. 
+            ///@see ncc::ode::object::set_collision_category
+            void ray_cast(const ray_query_list& rays, query_hit_list& hits, 
+                    query_mode mode = closest_hit, unsigned long mask = ~0ul);
+
+            ///Finds the objects overlapping a sphere.
+            ///
+            ///The hits are appended to hits, one for each object.
+            ///@return The number of objects found.
+            std::size_t overlap_sphere(double x, double y, double z, double radius, 
+                    query_hit_list& hits, unsigned long mask = ~0ul);
+
+            ///Finds the objects overlapping an axis aligned box.
+            ///
+            ///The hits are appended to hits, one for each object.
+            ///@return The number of objects found.
+            std::size_t overlap_box(double x, double y, double z, 
+                    double size_x, double size_y, double size_z, 
+                    query_hit_list& hits, unsigned long mask = ~0ul);
             //
             ///Returns a refrence to the trimesh_cache
             ///@{
@@ -109,6 +326,51 @@ namespace ode
             const trimesh_data_cache& trimesh_cache() const {return mesh_cache;}
             ///@}
         private:          
+            friend void near_callback(void* mgr, dGeomID o1, dGeomID o2);
+
+            ///A collision of a pair of geoms of which at least one has a 
+            ///collision callback.
+            struct collision_record
+            {
+                const geom_data* key_1; ///< The geoms of the pair ordered by
+                const geom_data* key_2; ///< address, used to sort records.
+                const geom_data* geom_1; ///< key_1, or 0 once forgotten.
+                const geom_data* geom_2; ///< key_2, or 0 once forgotten.
+                collision_info info; ///< As seen by geom_1.
+                bool ignored; ///< True if the callbacks declined contact joints.
+            };
+            typedef std::vector<collision_record> collision_list;
+
+            ///Orders records by pair.
+            static bool earlier_pair(const collision_record& first, const collision_record& second)
+            {
+                return first.key_1 < second.key_1 || (first.key_1 == second.key_1 && first.key_2 < second.key_2);
+            }
+
+            ///Records the collision of a pair from the contacts dCollide 
+            ///returned. Returns false if no contact joints should be created.
+            bool record_collision(const geom_data* geom_1, const geom_data* geom_2, const dContact* contacts, int count);
+
+            ///Calls the collision callbacks of the recorded collisions.
+            void deliver_collisions();
+
+            ///Calls the callbacks of both objects of a collision.
+            void deliver_collision(collision_record& record, collision_info::collision_state state);
+
+            ///Returns the surface of a pair of materials which is not in the 
+            ///table.
+            dSurfaceParameters pair_surface(material_id first, material_id second) const;
+
+            ///Sets the surfaces in the table of a new material.
+            void fill_surfaces(material_id added);
+
+            ///Tests a query geom against both spaces. A ray fills hit and 
+            ///an overlap appends to hits.
+            void query(dGeomID geom, query_mode mode, unsigned long mask, query_hit* hit, query_hit_list* hits);
+
+            ///Casts one ray with the reused ray geom.
+            void cast_ray(const ray_query& ray, query_mode mode, unsigned long mask, query_hit& hit);
+
             double ERP;// = 0.999;
 
             /// ODE's "Constraint Force Mixing". This is empirically defined.
@@ -123,8 +385,33 @@ namespace ode
             /// ODE space for collision detection.
             dSpaceID space_id;
 
+            /// ODE space of the objects without rigid bodies.
+            dSpaceID static_space_id;
+
+            /// Geoms reused by the queries, they are in no space.
+            dGeomID ray_geom;
+            dGeomID sphere_geom;
+            dGeomID box_geom;
+
             trimesh_data_cache mesh_cache;
 
+            typedef std::pair<double, double> material_key; ///< friction and bounce.
+            typedef std::map<material_key, material_id> material_map;
+            material_map material_index;
+            std::vector<material_key> materials;
+            std::vector<std::size_t> material_uses; ///< 0 once a material is removed.
+            std::set<material_id> free_materials; ///< the ids of removed materials.
+            std::vector<dSurfaceParameters> surfaces; ///< indexed by 
+            ///first * table_width + second.
+            std::size_t table_width; ///< the materials in the table.
+            typedef std::map<std::pair<material_id, material_id>, dSurfaceParameters> surface_map;
+            surface_map pair_surfaces; ///< the surfaces set for pairs not in
+            ///the table, keyed by the smaller id first.
+
+            collision_list collisions; ///< recorded during the current step.
+            collision_list touching; ///< the collisions of the last step, 
+            ///sorted by pair.
+
     };
 } //namespace ode
 } //namespace ncc
@@ -92,13 +92,33 @@ namespace ode
             virtual void set_velocity(double x, double y, double z);
 
             virtual double get_mass() const {return material.mass;}
-            virtual void set_bounce(double bounce) { material.bounce = bounce;}
+            virtual void set_bounce(double bounce) { material.bounce = bounce; update_material();}
             virtual double get_bounce() const { return material.bounce;}
-            virtual void set_friction(double friction) {material.friction = friction;}
+            virtual void set_friction(double friction) {material.friction = friction; update_material();}
             virtual double get_friction() const { return material.friction;}
 
             virtual void update(){}
 
+            ///Returns true if update only changes the object itself.
+            ///
+            ///ODE is not thread safe, so a class whose update changes the 
+            ///physics world must return false to be updated on the thread 
+            ///which steps the object manager.
+            virtual bool is_thread_safe() const { return true;}
+
+            ///Returns true if the object may have moved since the last call to 
+            ///synced.
+            ///
+            ///An object without a rigid body only moves when its position or 
+            ///orientation is set. A rigid body moves while ODE keeps it 
+            ///enabled, so a body which ODE auto disabled costs nothing to sync.
+            bool needs_sync() const { return moved || (body_id && dBodyIsEnabled(body_id));}
+
+            ///Marks the object as synced with its visual body.
+            ///
+            ///A body which is still enabled is synced once more after ODE 
+            ///disables it so that the visual body gets its final resting place.
+            void synced() { moved = body_id && dBodyIsEnabled(body_id);}
 
             //extra functions
             virtual void add_force_at_pos(double x, double y, double z, 
@@ -118,13 +138,63 @@ namespace ode
             { if(body_id) dBodyAddRelForceAtRelPos(body_id, x, y, z, px, py, pz);}
 
 
+            ///Sets the callback called after each step for each object the 
+            ///object touched, began touching, or stopped touching.
+            ///
+            ///The callback is called with contact_begin, contact_persist, and
+            ///contact_end collisions, so one which should act once per 
+            ///collision checks the state of the ncc::ode::collision_info.
             void set_collision_callback(collision_callback callback){ collision_callback_ptr = callback;}
             collision_callback& callback(){ return collision_callback_ptr;}
+
+            ///Sets whether the object gets contact joints when it touches 
+            ///another object.
+            ///
+            ///An object which is not solid, such as a trigger or a pickup, 
+            ///passes through the others from the first step it touches them,
+            ///while its collision callback is still called. Objects are solid
+            ///by default.
+            void set_solid(bool solid) { geom_info.solid = solid;}
+            bool is_solid() const { return geom_info.solid;}
+
+            ///Sets the collision categories the object belongs to.
+            ///
+            ///Two objects are only tested for collision if the categories of 
+            ///one share a bit with the mask of the other. ODE discards the 
+            ///other pairs before the near callback is called, so objects 
+            ///which never interact, such as two bullets, cost no narrow phase
+            ///work. By default an object belongs to every category and 
+            ///collides with every category.
+            void set_collision_category(unsigned long bits);
+            unsigned long get_collision_category() const { return category_bits;}
+
+            ///Sets the collision categories the object collides with.
+            void set_collision_mask(unsigned long bits);
+            unsigned long get_collision_mask() const { return collide_bits;}
+
+            ///Puts the object in one of 32 collision layers.
+            ///
+            ///The category of the object becomes the bit of the layer. 
+            ///@param layer The layer from 0 to 31.
+            ///@param mask The layers the object collides with, a bit for each
+            ///layer.
+            //@{
+            void set_collision_layer(unsigned int layer) { set_collision_category(1ul << layer);}
+            void set_collision_layer(unsigned int layer, unsigned long mask) { set_collision_category(1ul << layer); set_collision_mask(mask);}
+            //@}
             ///Returns the dBodyID associated with the rigid body.
             ///
             ///The dBodyID can be used to do more advanced things with the ODE api. 
             dBodyID get_ode_body() { return body_id;}		
-            virtual ~object() {if(body_id) dBodyDestroy(body_id);}
+            virtual ~object() 
+            {
+                if(manager_ptr) 
+                {
+                    manager_ptr->forget_collisions(&geom_info);
+                    manager_ptr->release_material(geom_info.material);
+                }
+                if(body_id) dBodyDestroy(body_id);
+            }
         protected:
             ///Create a rigid body at a certain position
             ///
@@ -133,12 +203,24 @@ namespace ode
             ///objects to create a rigid body
             virtual void create_rigid_body(double x, double y, double z, manager& mgr);
 
-            void set_geom_data(dGeomID geom);
+            ///Points the data of the geom to the geom_data of the object.
+            void set_geom_data(dGeomID geom, manager& mgr);
+
+            ///Looks up the material of the friction and bounce in the manager
+            ///and releases the one the object had.
+            void update_material();
             dWorldID world_id;
             dSpaceID space_id;
             dBodyID body_id;
             object_material material;
             collision_callback collision_callback_ptr;
+            geom_data geom_info;
+            dGeomID collision_geom; ///< the geom given to set_geom_data.
+            unsigned long category_bits;
+            unsigned long collide_bits;
+            manager* manager_ptr; ///< set with the geom data.
+            bool moved; ///< true if the position or orientation was set since
+            ///the last sync.
             ///finish collision callback code
     };
 
@@ -152,6 +234,18 @@ namespace ode
             virtual void set_orientation(double x, double y, double z, double w);
             virtual ~collidable_object() { if(geom_id) dGeomDestroy(geom_id);}
         protected:
+            ///Returns the space of the manager for an object of the mass.
+            dSpaceID select_space(double mass, manager& mgr) { return mass > 0 ? mgr.ode_space() : mgr.ode_static_space();}
+
+            ///Gives the object a rigid body if the mass is above 0 and takes 
+            ///it away otherwise.
+            ///
+            ///The geom is moved between the space of the rigid bodies and the
+            ///static space of the manager, keeping its position and 
+            ///orientation.
+            ///@return True if the object has a rigid body.
+            bool update_dynamics(double mass);
+
             dGeomID geom_id;
     };
 
@@ -311,6 +405,8 @@ namespace ode
                     manager& mgr);        
             virtual void set_mass(double mass);
             virtual void update();
+            ///The update moves the geom, so it is not thread safe.
+            virtual bool is_thread_safe() const { return false;}
         protected:
             trimesh_data_cache::data_ptr mesh_data;
             double size[3];
@@ -332,7 +428,7 @@ namespace ode
     class capsule : public collidable_object
     {
         public:
-            capsule() : radius(0), length(0), collidable_object(){}
+            capsule() : amotor_id(0), radius(0), length(0), collidable_object(){}
 
             ///Creates the rigid body capsule
             ///
@@ -350,6 +446,10 @@ namespace ode
                     manager& mgr);
             virtual void set_mass(double mass);          
         private:
+            ///Attaches the motor which keeps the body upright, creating it 
+            ///if needed.
+            void keep_upright();
+
             dJointID amotor_id;
             double radius;
             double length;
@@ -39,6 +39,7 @@
 #include "utilities/property_manager.h"
 #include "sound/oal_manager.h"
 #include <list>
+#include <vector>
 #include <iostream>
 #include <functional>
 namespace ncc {
@@ -88,9 +89,25 @@ namespace lua
             ///Calls the handle_message function within the script.
             ///
             ///This calls the handle_message function and passes it a message, a
-            ///parameter list, and the object which sent the message.
+            ///parameter list, and the handle of the controller which sent the
+            ///message.
+            ///If the script has a handle_messages function, the message is 
+            ///queued instead and passed to handle_messages by 
+            ///messages_delivered.
             void handle_message(const parameter& message, const parameter_list& params, controller::abstract_interface& from);
 
+            ///Calls the handle_messages function within the script with all
+            ///messages queued by handle_message.
+            ///
+            ///The function is called once per step with one parameter, a 
+            ///table of the messages in the order they were sent. Each entry 
+            ///is a table with "message", "params", and "from" fields, like 
+            ///the parameters of handle_message. This crosses from C++ to Lua 
+            ///once per step instead of once per message, and the messages 
+            ///and parameters are passed by pointer so a message broadcast to
+            ///many scripts is not copied for each of them.
+            void messages_delivered();
+
             ///Returns the type of the controller.
             std::string get_type() {return "script_controller";}
 
@@ -100,6 +117,7 @@ namespace lua
             object::manager& object_manager() { return object_mgr;}
             ncc::controller::manager& controller_manager() { return controller_mgr;}
             property::manager& property_manager() {return property_mgr;}
+            lua_State* lua_state() { return lua_script.state();}
 
             ///This method calls remove_self. 
             ///
@@ -111,7 +129,13 @@ namespace lua
             ///
             ///In a script call "game:set_collision_callback(object, "some_function")"
             ///Then that function will be called when the object collides. That 
-            ///function must take one object parameter. 
+            ///function must take one object parameter. It is also passed a 
+            ///collision_info, whose state tells if the collision began, 
+            ///persisted, or ended. The function is called after the physics 
+            ///step, once per step for each object it touches, so a function 
+            ///which should act once per collision checks that info.state is 
+            ///ncc.collision_info.contact_begin. Set the object's solid 
+            ///property to false for it to pass through other objects.
             void set_collision_callback(ode::object* object, const std::string& function);
 
             ///This is the function which is called when an ode::object within
@@ -122,6 +146,15 @@ namespace lua
             ///function within the script to call.
             bool collision_callback(ode::collision_info info);
 
+            ///Calls the destroy function within the script and makes the 
+            ///controller ready to be initialized again.
+            ///
+            ///The script stays loaded, so a recycled script controller is 
+            ///initialized without creating a new lua_State or loading the 
+            ///file. Scripts of pooled prototypes should therefore set up all 
+            ///of their state in their initialize function.
+            bool recycle();
+
             ///Returns the function pointer to the bind function.
             const boost::function<void(lua_State*)>& get_bind_function() const {return bind_function;}
             ~controller();
@@ -129,6 +162,13 @@ namespace lua
             controller::abstract_interface* clone_prototype();
 
         private:
+            ///Loads the script if it is not loaded yet and sets the globals 
+            ///it expects.
+            bool prepare();
+
+            ///Calls the destroy function within the script if initialize was
+            ///called since the last time.
+            void destroy();
 
             typedef std::map<ncc::object::abstract_interface*, std::string> callback_map;
             callback_map callbacks;
@@ -141,6 +181,21 @@ namespace lua
             script lua_script; 
             std::string file_name;
             boost::function<void(lua_State*)> bind_function;
+            bool initialized; ///< true if the script's initialize was called.
+            bool batch_messages; ///< true if the script has handle_messages.
+
+            ///A message queued for handle_messages.
+            struct queued_message
+            {
+                const parameter* message;
+                const parameter_list* params;
+                handle from;
+                ///Hold the message and parameters of typed messages 
+                ///converted for the script.
+                parameter script_message;
+                parameter_list script_params;
+            };
+            std::vector<queued_message> queued_messages;
 
     };
 
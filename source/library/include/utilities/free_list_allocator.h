@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+#ifndef NCCENTRIFUGE_FREE_LIST_ALLOCATOR_H
+#define NCCENTRIFUGE_FREE_LIST_ALLOCATOR_H
+
+#include <new>
+#include <cstddef>
+#include <boost/lockfree/stack.hpp>
+namespace ncc
+{
+    ///The blocks kept for reuse by ncc::free_list_allocator, one free list 
+    ///for each type.
+    ///
+    ///The free list is a fixed size lock free stack so that any thread can 
+    ///take a block from it or give one back without taking a lock. Blocks 
+    ///which do not fit in the free list are returned to the heap.
+    template <class type>
+        class free_list
+    {
+        public:
+            enum { capacity = 4096 }; ///< the most blocks kept for reuse.
+
+            static void* allocate()
+            {
+                void* block = 0;
+                if(blocks().pop(block)) return block;
+                return ::operator new(sizeof(type));
+            }
+
+            static void deallocate(void* block)
+            {
+                if(!blocks().bounded_push(block)) ::operator delete(block);
+            }
+        private:
+            typedef boost::lockfree::stack<void*, boost::lockfree::capacity<capacity> > block_stack;
+
+            ///The free list is made the first time it is used. Later calls 
+            ///only check that it was made.
+            static block_stack& blocks()
+            {
+                static block_stack free_blocks;
+                return free_blocks;
+            }
+    };
+
+    ///An allocator which keeps freed objects in a lock free ncc::free_list.
+    ///
+    ///Unlike boost::fast_pool_allocator, whose pools are guarded by a mutex, 
+    ///this allocator can be used by many threads at once without locking 
+    ///once the free list holds blocks. Allocating when the free list is empty
+    ///goes to the heap. Only single objects are taken from the free list, 
+    ///arrays always come from the heap.
+    template <class type>
+        class free_list_allocator
+    {
+        public:
+            typedef type value_type;
+            typedef type* pointer;
+            typedef const type* const_pointer;
+            typedef type& reference;
+            typedef const type& const_reference;
+            typedef std::size_t size_type;
+            typedef std::ptrdiff_t difference_type;
+
+            template <class other_type>
+                struct rebind { typedef free_list_allocator<other_type> other;};
+
+            free_list_allocator() {}
+            template <class other>
+                free_list_allocator(const free_list_allocator<other>&) {}
+
+            pointer address(reference value) const { return &value;}
+            const_pointer address(const_reference value) const { return &value;}
+
+            pointer allocate(size_type count, const void* = 0)
+            {
+                if(count == 1) return static_cast<pointer>(free_list<type>::allocate());
+                return static_cast<pointer>(::operator new(count * sizeof(type)));
+            }
+
+            void deallocate(pointer block, size_type count)
+            {
+                if(count == 1) free_list<type>::deallocate(block);
+                else ::operator delete(block);
+            }
+
+            size_type max_size() const { return size_type(-1) / sizeof(type);}
+
+            void construct(pointer block, const type& value) { new(block) type(value);}
+            void destroy(pointer block) { block->~type();}
+
+            template <class other>
+                bool operator == (const free_list_allocator<other>&) const { return true;}
+            template <class other>
+                bool operator != (const free_list_allocator<other>&) const { return false;}
+    };
+}//namespace ncc
+#endif
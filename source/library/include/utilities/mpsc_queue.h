@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+#ifndef NCCENTRIFUGE_MPSC_QUEUE_H
+#define NCCENTRIFUGE_MPSC_QUEUE_H
+
+#include <boost/utility.hpp>
+#include <boost/atomic.hpp>
+namespace ncc
+{
+    ///The link a type derives from to be put in an ncc::mpsc_queue.
+    struct mpsc_node
+    {
+        mpsc_node() : mpsc_next(0) {}
+        boost::atomic<mpsc_node*> mpsc_next;
+    };
+
+    ///A lock free queue with many producers and a single consumer.
+    ///
+    ///The queue is intrusive. The objects put in the queue derive from 
+    ///ncc::mpsc_node and are the nodes of the queue, so pushing and popping 
+    ///never allocate. Any thread can push. Only one thread at a time may 
+    ///pop. The queue does not own the objects in it.
+    template <class node_type>
+        class mpsc_queue : boost::noncopyable
+    {
+        public:
+            mpsc_queue() : head(&stub), tail(&stub) {}
+
+            ///Puts a node at the back of the queue. Can be called from any 
+            ///thread.
+            void push(node_type* node) { push_node(node);}
+
+            ///Takes the node at the front of the queue.
+            ///
+            ///Must only be called by the consumer thread.
+            ///@return 0 if the queue is empty, or if the next node is still 
+            ///being pushed, in which case it is returned by a later pop.
+            node_type* pop()
+            {
+                mpsc_node* current = tail;
+                mpsc_node* next = current->mpsc_next.load(boost::memory_order_acquire);
+
+                //the stub is never returned.
+                if(current == &stub)
+                {
+                    if(!next) return 0;
+                    tail = next;
+                    current = next;
+                    next = next->mpsc_next.load(boost::memory_order_acquire);
+                }
+
+                if(next)
+                {
+                    tail = next;
+                    return static_cast<node_type*>(current);
+                }
+
+                //current is the last node. It can only be taken once another 
+                //node is behind it so the stub is pushed.
+                if(current != head.load(boost::memory_order_acquire)) return 0;
+                push_node(&stub);
+
+                next = current->mpsc_next.load(boost::memory_order_acquire);
+                if(!next) return 0;
+                tail = next;
+                return static_cast<node_type*>(current);
+            }
+        private:
+            void push_node(mpsc_node* node)
+            {
+                node->mpsc_next.store(0, boost::memory_order_relaxed);
+                mpsc_node* previous = head.exchange(node, boost::memory_order_acq_rel);
+                previous->mpsc_next.store(node, boost::memory_order_release);
+            }
+
+            boost::atomic<mpsc_node*> head; ///< the last node pushed.
+            mpsc_node* tail; ///< the next node popped. Only used by the consumer.
+            mpsc_node stub;
+    };
+}//namespace ncc
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+#ifndef NCCENTRIFUGE_THREAD_POOL_H
+#define NCCENTRIFUGE_THREAD_POOL_H
+
+#include <deque>
+#include <vector>
+#include <boost/utility.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+namespace ncc
+{
+    ///A pool of threads which runs batches of tasks.
+    ///
+    ///Each thread, including the one calling run, has its own queue of 
+    ///tasks. A thread takes tasks from the back of its own queue and when it
+    ///runs out it steals from the front of the other queues, so that a batch 
+    ///of uneven tasks is still spread over all threads. The run method 
+    ///returns only once every task of the batch has finished.
+    ///\n\n
+    ///Tasks must not throw exceptions.
+    class thread_pool : boost::noncopyable
+    {
+        public:
+            typedef boost::function<void()> task;
+            typedef std::vector<task> task_list;
+
+            ///Creates the pool.
+            ///@param threads The number of threads which run tasks, counting 
+            ///the thread which calls run. If 0 then the number of hardware 
+            ///threads is used.
+            explicit thread_pool(unsigned int threads = 0);
+            ~thread_pool();
+
+            ///Runs all tasks and waits for them to finish.
+            ///
+            ///The calling thread runs tasks as well while it waits. The 
+            ///tasks are not copied so the list must not change until run 
+            ///returns.
+            void run(task_list& tasks);
+
+            ///Returns the number of threads which run tasks, counting the 
+            ///thread which calls run.
+            unsigned int size() const { return queues.size();}
+        private:
+            ///Waits for batches and runs their tasks.
+            void work(unsigned int index);
+
+            ///Runs a task from the queue at index or steals one from another 
+            ///queue. Returns false if there are no tasks left to take.
+            bool run_task(unsigned int index);
+
+            struct task_queue
+            {
+                boost::mutex lock;
+                std::deque<task*> tasks;
+            };
+            typedef boost::shared_ptr<task_queue> queue_ptr;
+
+            std::vector<queue_ptr> queues;
+            boost::thread_group threads;
+
+            boost::mutex state_lock;
+            boost::condition_variable work_ready;
+            boost::condition_variable work_done;
+            unsigned long batch;        ///< incremented for every batch run.
+            std::size_t remaining;      ///< the tasks of the batch not yet finished.
+            bool stopping;
+    };
+}//namespace ncc
+#endif
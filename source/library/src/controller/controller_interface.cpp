@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+#include "controller/controller_manager.h"
+#include "utilities/clock.h"
+namespace ncc {
+namespace controller
+{
+    void abstract_interface::set_name(const std::string& value)
+    {
+        if(manager_ptr) manager_ptr->rename_controller(*this, name_holder, value);
+        name_holder = value;
+    }
+
+    void abstract_interface::remove_self()
+    {
+        if(!alive) return;
+        alive = false;
+        //a managed controller is always owned by the tree so self is safe.
+        if(manager_ptr) manager_ptr->queue_removal(self());
+    }
+
+    void abstract_interface::sleep()
+    {
+        sleeping = true;
+        wake_time = 0;
+    }
+
+    void abstract_interface::sleep(double seconds)
+    {
+        sleeping = true;
+        wake_time = monotonic_seconds() + seconds;
+    }
+
+    bool abstract_interface::add_child(node_type new_child)
+    {
+        if(!tree::is_node<abstract_interface>::add_child(new_child)) return false;
+        if(manager_ptr) manager_ptr->index_controller(new_child);
+        return true;
+    }
+
+    bool abstract_interface::remove_child(node_type target_child)
+    {
+        if(!tree::is_node<abstract_interface>::remove_child(target_child)) return false;
+        if(manager_ptr) manager_ptr->unindex_controller(target_child);
+        return true;
+    }
+}//namespace controller
+}//namespace ncc
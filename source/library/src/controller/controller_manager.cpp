@@ -30,12 +30,24 @@
  */
 
 #include "controller/controller_manager.h"
+#include "utilities/clock.h"
 namespace ncc {
 namespace controller
 {
-    manager::manager()
+    ///The change buffers are owned by the manager, not the thread.
+    void keep_changes(std::vector<boost::function<void()> >*) {}
+
+    manager::manager() : 
+        time_budget(0),
+        step_start(0),
+        low_priority_buckets(4),
+        low_priority_round(1),
+        round_cut(false),
+        step_thread(boost::this_thread::get_id()),
+        deferred_changes(keep_changes)
     {
         root_controller = ptr(new hidden::simple_root_controller());
+        index_controller(root_controller);
     }
     void manager::add_controller(ptr new_controller)
     {
@@ -48,6 +60,8 @@ namespace controller
     void manager::add_controller(ptr new_controller, ptr parent)
     {
         if(!parent || !new_controller) return;
+        //the parent may belong to a subtree controlled by another thread.
+        if(defer(boost::bind(&abstract_interface::add_child, parent, new_controller))) return;
         parent->add_child(new_controller);
     }
     void manager::add_controller(ptr new_controller, const parameter_list& params, ptr& parent)
@@ -56,10 +70,13 @@ namespace controller
         
         if(new_controller->initialize(params) == false) return;
         
-        parent->add_child(new_controller);
+        add_controller(new_controller, parent);
     }
 	void manager::add_prototype(const std::string& name, ptr& prototype)
     {
+        //subtrees controlled in parallel look prototypes up while creating 
+        //controllers, so the map only changes once they are done.
+        if(defer(boost::bind(&manager::add_prototype, this, name, prototype))) return;
         if(prototype && !name.empty()) prototypes[name] = prototype;
     }
 	
@@ -69,17 +86,142 @@ namespace controller
         return found_prototype != prototypes.end() ? found_prototype->second : ptr();
     }
 
+    manager::controller_pool::~controller_pool()
+    {
+        for(std::size_t index = 0; index < free.size(); ++index)
+            delete free[index];
+    }
+
+    bool manager::reset_controller(abstract_interface& controller)
+    {
+        //the children died with the controller.
+        controller.children().clear();
+        controller.name_holder.clear();
+        controller.alive = true;
+        controller.queued = false;
+        controller.manager_ptr = 0;
+        controller.handle_holder = handle();
+        controller.update_interval = 0;
+        controller.next_control = 0;
+        controller.low_priority = false;
+        controller.controlled_round = 0;
+        controller.wake();
+        //a new id is assigned so that the recycled controller cannot be 
+        //mistaken for the dead one.
+        static_cast<id_type&>(controller) = id_type();
+        return controller.recycle();
+    }
+
+    void manager::recycle_controller(const recycler& deleter, abstract_interface* controller)
+    {
+        if(deleter.recycled)
+        {
+            if(pool_ptr pool = deleter.pool.lock())
+            {
+                boost::mutex::scoped_lock lock(pool->lock);
+                if(pool->free.size() < pool->capacity) 
+                {
+                    pool->free.push_back(controller);
+                    return;
+                }
+            }
+        }
+        delete controller;
+    }
+
+    void manager::recycle_dead_controller(ptr& controller)
+    {
+        //a controller held by something else, such as a message or a 
+        //script, does not die now. A pooled one is tried again on the next
+        //reclaim, unless it is already on the dead list.
+        if(controller.use_count() != 1) 
+        {
+            if(!controller->queued && boost::get_deleter<recycler>(controller)) queue_dead_controller(controller);
+            return;
+        }
+
+        //the children are cleared by the reset so they are recycled first.
+        abstract_interface::child_list_type& children = controller->children();
+        for(std::size_t child = 0; child < children.size(); ++child)
+            recycle_dead_controller(children[child]);
+
+        if(recycler* deleter = boost::get_deleter<recycler>(controller))
+            deleter->recycled = reset_controller(*controller);
+    }
+
+    void manager::set_prototype_pool(const std::string& name, std::size_t size, std::size_t warm_up)
+    {
+        //the pools are looked up by create_controller on every thread 
+        //controlling a subtree, so they only change once those are done.
+        if(defer(boost::bind(&manager::set_prototype_pool, this, name, size, warm_up))) return;
+        pool_map::iterator found = pools.find(name);
+        if(size == 0)
+        {
+            //controllers still alive are deleted when they die because their
+            //pool is gone.
+            if(found != pools.end()) pools.erase(found);
+            return;
+        }
+
+        ptr prototype(find_prototype(name));
+        if(!prototype) return;
+
+        pool_ptr pool = found != pools.end() ? found->second : pool_ptr(new controller_pool());
+        pools[name] = pool;
+
+        boost::mutex::scoped_lock lock(pool->lock);
+        pool->capacity = size;
+        for(std::size_t count = std::min(warm_up, size); pool->free.size() < count;)
+        {
+            abstract_interface* clone = prototype->clone_prototype();
+            if(!clone) break;
+            if(!clone->recycle()) 
+            {
+                delete clone;
+                break;
+            }
+            pool->free.push_back(clone);
+        }
+    }
+
+    ptr manager::take_pooled_controller(const std::string& type)
+    {
+        pool_map::iterator found = pools.find(type);
+        if(found == pools.end()) return ptr();
+
+        boost::mutex::scoped_lock lock(found->second->lock);
+        if(found->second->free.empty()) return ptr();
+        abstract_interface* controller = found->second->free.back();
+        found->second->free.pop_back();
+        lock.unlock();
+
+        recycler deleter = {found->second, false};
+        return ptr(controller, deleter);
+    }
+
     ptr manager::create_controller(const std::string& type, const parameter_list& params)
     {
-        
-        ptr controller_to_create(find_prototype(type));
+        ptr new_controller = take_pooled_controller(type);
+        if(!new_controller)
+        {
+            ptr controller_to_create(find_prototype(type));
 
-        //because we could not find a controller of the specified type to clone, we return 0
-        if(!controller_to_create) return ptr();
-        
-        ptr new_controller(controller_to_create->clone_prototype());
-        //because the controller was unable to be cloned, we return 0
-        if(!new_controller) return ptr();
+            //because we could not find a controller of the specified type to clone, we return 0
+            if(!controller_to_create) return ptr();
+
+            abstract_interface* clone = controller_to_create->clone_prototype();
+            //because the controller was unable to be cloned, we return 0
+            if(!clone) return ptr();
+
+            //controllers of a pooled prototype go back to the pool when they die.
+            pool_map::iterator pool = pools.find(type);
+            if(pool != pools.end())
+            {
+                recycler deleter = {pool->second, false};
+                new_controller = ptr(clone, deleter);
+            }
+            else new_controller = ptr(clone);
+        }
         
         //because a controller can be configured using its initialize function, we do so. 
         //if it returns false then we had an error during initialization
@@ -99,36 +241,34 @@ namespace controller
         return weak_ptr(new_controller);
     }
 
-    bool remove_controller_by_name(ptr& controller, const std::string& name)
+    void remove_target(ptr& controller)
     {
-        if(controller->get_name().size() && controller->get_name() == name)
-        {
-            manager::remove_controller(controller);
-            return false;
-        }
-        return true;
+        manager::remove_controller(controller);
     }
-    
+
     void manager::remove_controller(const std::string& name)
     {
-        using namespace boost;
-        tree::transverse_depth_first(root_controller, boost::bind<bool>(remove_controller_by_name, _1, name));
+        string_index::iterator found = name_index.find(name);
+        if(found == name_index.end()) return;
+
+        id_map::iterator end = found->second.end();
+        for(id_map::iterator controller = found->second.begin(); controller != end; ++controller)
+            if(abstract_interface* target = handles.get(controller->second)) 
+            {
+                ptr removed = target->self();
+                if(!defer(boost::bind(remove_target, removed))) remove_controller(removed);
+            }
     }
-    
 
-    bool remove_controller_by_id(ptr& controller, id_type id) 
+    void manager::remove_controller(const id_type& id)
     {
-        if(controller->get_id() == id)
-        { 
-            manager::remove_controller(controller);
-            return false;
+        id_map::iterator found = id_index.find(id.get_id());
+        if(found == id_index.end()) return;
+        if(abstract_interface* target = handles.get(found->second)) 
+        {
+            ptr removed = target->self();
+            if(!defer(boost::bind(remove_target, removed))) remove_controller(removed);
         }
-        return true;
-    }
-    
-    void manager::remove_controller(id_type id)
-    {
-        tree::transverse_depth_first(root_controller, boost::bind<bool>(remove_controller_by_id, _1, id));
     }
     
     void manager::remove_controller(ptr& controller)
@@ -136,47 +276,44 @@ namespace controller
         if(controller) controller->remove_self();
     }
     
-    inline bool controller_has_name(ptr& cntr, const std::string& name) 
-    {
-        return cntr->get_name().size() && cntr->get_name() == name;
-    }
-    
-    inline bool controller_has_id(ptr& controller, id_type id)  {return controller->get_id() == id;}    
-    inline bool controller_has_type(ptr& cntr, const std::string& type) { return cntr->get_type() == type;}
-    
     weak_ptr manager::find_controller(const std::string& name)
     {
-        using namespace boost;
-        return tree::depth_first_search(root_controller, bind(controller_has_name, _1, ref(name)));
+        string_index::iterator found = name_index.find(name);
+        if(found == name_index.end()) return weak_ptr();
+
+        id_map::iterator end = found->second.end();
+        for(id_map::iterator controller = found->second.begin(); controller != end; ++controller)
+            if(abstract_interface* target = handles.get(controller->second)) return target->self();
+        return weak_ptr();
     }
     weak_ptr manager::find_controller(const id_type& controller_id)
     {
-        using namespace boost;
-        return tree::depth_first_search(root_controller, bind(controller_has_id, _1, ref(controller_id)));
+        id_map::iterator found = id_index.find(controller_id.get_id());
+        if(found == id_index.end()) return weak_ptr();
+        abstract_interface* target = handles.get(found->second);
+        return target ? weak_ptr(target->self()) : weak_ptr();
     }
     
-    bool add_if_name_is(ptr& controller, list& controllers, const std::string& name)
-    {
-        if(controller->get_name() == name) controllers.push_back(controller);
-        return true;
-    }
     void manager::find_controllers(const std::string& name, list& controllers)
     {
-        using namespace boost;
-        tree::transverse_depth_first(root_controller, bind<bool>(add_if_name_is, _1, ref(controllers), ref(name)));
+        string_index::iterator found = name_index.find(name);
+        if(found == name_index.end()) return;
+
+        id_map::iterator end = found->second.end();
+        for(id_map::iterator controller = found->second.begin(); controller != end; ++controller)
+            if(abstract_interface* found_controller = handles.get(controller->second)) controllers.push_back(found_controller->self());
     }
     
-    bool add_if_type_is(ptr& controller, list& controllers, const std::string& type)
-    {
-        if(controller->get_type() == type) controllers.push_back(controller);
-        return true;
-    }
     void manager::find_controllers_by_type(const std::string& type, list& controllers)
     {
-        using namespace boost;
-        tree::transverse_depth_first(root_controller, bind<bool>(add_if_type_is, _1, ref(controllers), ref(type))); 
+        string_index::iterator found = type_index.find(type);
+        if(found == type_index.end()) return;
+
+        id_map::iterator end = found->second.end();
+        for(id_map::iterator controller = found->second.begin(); controller != end; ++controller)
+            if(abstract_interface* found_controller = handles.get(controller->second)) controllers.push_back(found_controller->self());
     }
-    
+
     bool add_to_list(ptr& controller, list& controllers)
     {
         if(controller) controllers.push_back(controller);
@@ -185,59 +322,281 @@ namespace controller
     void manager::create_flat_list(list& controllers)
     {
         using namespace boost;
-        tree::transverse_depth_first(root_controller, bind<bool>(add_to_list, _1, ref(controllers)));
+        tree::transverse_depth_first(root_controller, bind<bool>(add_to_list, _1, boost::ref(controllers)));
+    }
+
+    void manager::index_controller(ptr& controller)
+    {
+        if(!controller) return;
+        if(defer(boost::bind(&manager::index_controller, this, controller))) return;
+
+        const unsigned long id = controller->get_id();
+        controller->manager_ptr = this;
+        if(handles.get(controller->handle_holder) != controller.get()) 
+            controller->handle_holder = handles.create(controller.get());
+        const handle& indexed = controller->handle_holder;
+        id_index[id] = indexed;
+        if(controller->get_name().size()) name_index[controller->get_name()][id] = indexed;
+        type_index[controller->get_type()][id] = indexed;
+        //a controller which died before it was added is removed on the next step.
+        if(!controller->is_alive()) queue_dead_controller(controller);
+
+        //the children of a new controller are managed as well
+        abstract_interface::child_iterator end = controller->children_end();
+        for(abstract_interface::child_iterator child = controller->children_begin(); child != end; ++child)
+            index_controller(*child);
+    }
+
+    template <class index_type>
+    void remove_from_index(index_type& index, const std::string& key, unsigned long id)
+    {
+        typename index_type::iterator bucket = index.find(key);
+        if(bucket == index.end()) return;
+
+        bucket->second.erase(id);
+        //empty buckets are removed so that the index does not grow with 
+        //every name ever used.
+        if(bucket->second.empty()) index.erase(bucket);
+    }
+
+    void manager::unindex_controller(ptr& controller)
+    {
+        if(!controller) return;
+        if(defer(boost::bind(&manager::unindex_controller, this, controller))) return;
+        if(controller->manager_ptr != this) return;
+
+        const unsigned long id = controller->get_id();
+        controller->manager_ptr = 0;
+        //old handles of the controller stop working right away.
+        handles.release(controller->handle_holder);
+        controller->handle_holder = handle();
+        id_index.erase(id);
+        if(controller->get_name().size()) remove_from_index(name_index, controller->get_name(), id);
+        remove_from_index(type_index, controller->get_type(), id);
+
+        abstract_interface::child_iterator end = controller->children_end();
+        for(abstract_interface::child_iterator child = controller->children_begin(); child != end; ++child)
+            unindex_controller(*child);
+    }
+
+    void manager::rename_controller(abstract_interface& controller, 
+                                    const std::string& old_name, 
+                                    const std::string& new_name)
+    {
+        if(defer(boost::bind(&manager::rename_controller, this, boost::ref(controller), old_name, new_name))) return;
+
+        const unsigned long id = controller.get_id();
+        if(old_name.size()) remove_from_index(name_index, old_name, id);
+        if(new_name.size()) name_index[new_name][id] = controller.handle_holder;
     }
     
-    bool control(ptr& controller)
+    bool manager::control_scheduled(ptr& controller)
     {
-        return controller->control();
+        abstract_interface& target = *controller;
+        //a sleeping controller is skipped along with its children.
+        if(target.sleeping)
+        {
+            if(!target.wake_time || step_start < target.wake_time) return false;
+            target.wake();
+        }
+
+        //most controllers are controlled every step and do not need the clock.
+        if(target.update_interval <= 0 && !target.low_priority) return target.control();
+
+        if(target.update_interval > 0 && step_start < target.next_control) return true;
+
+        if(target.low_priority)
+        {
+            if(target.controlled_round == low_priority_round) return true;
+            if(target.get_id() % low_priority_buckets != low_priority_round % low_priority_buckets) return true;
+            if(time_budget > 0 && monotonic_seconds() - step_start > time_budget)
+            {
+                round_cut = true;
+                return true;
+            }
+            target.controlled_round = low_priority_round;
+        }
+
+        if(target.update_interval > 0) target.next_control = step_start + target.update_interval;
+        return target.control();
     }
     
-    bool should_remove(ptr& controller)
+    void manager::queue_removal(const ptr& controller)
+    {
+        if(defer(boost::bind(&manager::queue_removal, this, controller))) return;
+        queue_dead_controller(controller);
+    }
+
+    void manager::queue_dead_controller(const ptr& controller)
     {
-        return controller ? !controller->is_alive() : true;
+        if(controller->queued) return;
+        controller->queued = true;
+        dead_controllers.push_back(controller);
+    }
+
+    void manager::reclaim_controllers()
+    {
+        if(dead_controllers.empty()) return;
+
+        for(std::size_t index = 0; index < dead_controllers.size(); ++index)
+        {
+            ptr& controller = dead_controllers[index];
+            //controllers which are no longer managed were already detached, 
+            //either on their own or with a dead parent. The root is never 
+            //removed.
+            if(controller->manager_ptr != this || controller == root_controller) continue;
+            //removing the child unindexes it and all of its children.
+            controller->parent().remove_child(controller);
+        }
+        //pooled controllers are reset here, where the state they use, such
+        //as a lua_State, is known to be alive. Each one is taken off the 
+        //list before it is looked at, so the list does not count as a 
+        //holder. Those which are still held are put back on the list.
+        std::vector<ptr> dying;
+        dying.swap(dead_controllers);
+        for(std::size_t index = 0; index < dying.size(); ++index)
+        {
+            ptr controller;
+            controller.swap(dying[index]);
+            controller->queued = false;
+            recycle_dead_controller(controller);
+        }
+        //a dead subtree which nothing else holds is destroyed when it is 
+        //taken off the list.
     }
     
     void manager::step()
     {
+        //only written when it changes because other threads read it.
+        if(step_thread.load(boost::memory_order_relaxed) != boost::this_thread::get_id()) 
+            step_thread.store(boost::this_thread::get_id(), boost::memory_order_release);
+        step_start = monotonic_seconds();
+        round_cut = false;
+
         //walk through tree and control each object
-        tree::transverse_depth_first(root_controller, control);
+        if(pool) control_parallel();
+        else tree::transverse_depth_first(root_controller, boost::bind(&manager::control_scheduled, this, _1));
+
+        //the next bucket of low priority controllers is only started once 
+        //the current one is done.
+        if(!round_cut) ++low_priority_round;
         //send messages to appropriate objects
-        message_manager.send_messages(root_controller);
+        message_manager.send_messages(*this);
         //remove any objects which are not alive anymore
-        tree::remove_if(root_controller, should_remove); 
+        reclaim_controllers();
     }
     
+    void manager::enable_parallel_step(unsigned int threads)
+    {
+        pool.reset(new thread_pool(threads));
+    }
+
+    void manager::disable_parallel_step()
+    {
+        pool.reset();
+    }
+
+    bool manager::defer(const change& delayed)
+    {
+        change_list* changes = deferred_changes.get();
+        if(!changes) return false;
+        changes->push_back(delayed);
+        return true;
+    }
+
+    void manager::control_subtree(ptr& subtree, change_list* changes)
+    {
+        deferred_changes.reset(changes);
+        tree::transverse_depth_first(subtree, boost::bind(&manager::control_scheduled, this, _1));
+        deferred_changes.reset();
+    }
+
+    void manager::control_parallel()
+    {
+        if(!root_controller->control()) return;
+
+        abstract_interface::child_iterator end = root_controller->children_end();
+        abstract_interface::child_iterator child;
+
+        //the buffers are sized before the tasks are created so that the 
+        //tasks can point into them.
+        std::size_t parallel_count = 0;
+        for(child = root_controller->children_begin(); child != end; ++child)
+            if((*child)->is_thread_safe()) ++parallel_count;
+        if(subtree_changes.size() < parallel_count) subtree_changes.resize(parallel_count);
+
+        for(child = root_controller->children_begin(); child != end; ++child)
+        {
+            if((*child)->is_thread_safe())
+                subtree_tasks.push_back(boost::bind(&manager::control_subtree, this, *child, &subtree_changes[subtree_tasks.size()]));
+            else 
+                sequential_subtrees.push_back(*child);
+        }
+
+        pool->run(subtree_tasks);
+
+        //the changes are applied in the order of the subtrees so that the 
+        //result is the same no matter how the threads were scheduled.
+        for(std::size_t index = 0; index < subtree_tasks.size(); ++index)
+        {
+            change_list& changes = subtree_changes[index];
+            for(change_list::iterator delayed = changes.begin(); delayed != changes.end(); ++delayed)
+                (*delayed)();
+            changes.clear();
+        }
+        subtree_tasks.clear();
+
+        std::vector<ptr>::iterator sequential_end = sequential_subtrees.end();
+        for(std::vector<ptr>::iterator subtree = sequential_subtrees.begin(); subtree != sequential_end; ++subtree)
+            tree::transverse_depth_first(*subtree, boost::bind(&manager::control_scheduled, this, _1));
+        sequential_subtrees.clear();
+    }
+
+    void manager::post_message(message::ptr& msg)
+    {
+        //the change is only made when buffering, so that sending from a
+        //single thread does not allocate a boost::function.
+        if(change_list* changes = deferred_changes.get())
+        {
+            changes->push_back(boost::bind(&message::manager::add_message, &message_manager, msg));
+            return;
+        }
+        //messages from threads other than the one stepping, such as physics
+        //callbacks, go through the lock free queue.
+        if(boost::this_thread::get_id() != step_thread.load(boost::memory_order_acquire)) message_manager.post_message(msg);
+        else message_manager.add_message(msg);
+    }
+
     void manager::send_message(abstract_interface* sender,
                                 const std::string& name,
                                 const message::parcel& message)
     {
         if(!sender) return;
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    bind<bool>(controller_has_name, _1, name),
-                    message));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                message::message::to_name, 
+                name,
+                message);
     
-        message_manager.add_message(new_message);
+        post_message(new_message);
     }
     
-    message::parcel& manager::send_message(abstract_interface* sender, 
+    manager::message_builder manager::send_message(abstract_interface* sender, 
                                 const std::string& name, 
                                 const parameter& message)
     {
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    bind<bool>(controller_has_name, _1, name),
-                    message::parcel(message)));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                message::message::to_name, 
+                name,
+                message,
+                parameter_list());
     
-        message_manager.add_message(new_message);
-        return new_message->message_parcel;
+        return message_builder(this, new_message);
     }
     
     void manager::send_message(abstract_interface* sender, 
@@ -247,52 +606,46 @@ namespace controller
     {
         if(!sender) return;
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    bind<bool>(controller_has_name, _1, name),
-                    message::parcel(message, params)));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                message::message::to_name, 
+                name,
+                message,
+                params);
     
-        message_manager.add_message(new_message);
+        post_message(new_message);
     }
     
     
-    inline bool is_controller(ptr& controller_1, ptr& controller_2)
-    {
-        return controller_1 == controller_2;
-    }
-    
     void manager::send_message(abstract_interface* sender,
                                 ptr& to,
                                 const message::parcel& message)
     {
         if(!sender) return;
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    bind<bool>(is_controller,  _1 , to),
-                    message));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                to ? to->get_handle() : handle(),
+                message);
     
-        message_manager.add_message(new_message);
+        post_message(new_message);
     }
     
-    message::parcel& manager::send_message(abstract_interface* sender, 
+    manager::message_builder manager::send_message(abstract_interface* sender, 
                                 ptr& to, 
                                 const parameter& message)
     {
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    bind<bool>(is_controller,  _1 , to),
-                    message::parcel(message)));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                to ? to->get_handle() : handle(),
+                message,
+                parameter_list());
     
-        message_manager.add_message(new_message);
-        return new_message->message_parcel;
+        return message_builder(this, new_message);
     }
         
     void manager::send_message(abstract_interface* sender, 
@@ -302,14 +655,14 @@ namespace controller
     {
         if(!sender) return;
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    bind<bool>(is_controller,  _1 , to),
-                    message::parcel(message, params)));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                to ? to->get_handle() : handle(),
+                message,
+                params);
     
-        message_manager.add_message(new_message);
+        post_message(new_message);
     }
 
     
@@ -319,30 +672,30 @@ namespace controller
     {
         if(!sender) return;
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    bind<bool>(controller_has_type, _1, type),
-                    message));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                message::message::to_type, 
+                type,
+                message);
     
-        message_manager.add_message(new_message);
+        post_message(new_message);
     }
 
 
-    message::parcel& manager::send_message_to_all(abstract_interface* sender, 
+    manager::message_builder manager::send_message_to_all(abstract_interface* sender, 
                                         const std::string& type, 
                                         const parameter& message)
     {                
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    bind<bool>(controller_has_type, _1, type),
-                    message::parcel(message)));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                message::message::to_type, 
+                type,
+                message,
+                parameter_list());
     
-        message_manager.add_message(new_message);    
-        return new_message->message_parcel;
+        return message_builder(this, new_message);
     }
         
     void manager::send_message_to_all(abstract_interface* sender, 
@@ -352,44 +705,44 @@ namespace controller
     {
         if(!sender) return;
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    bind<bool>(controller_has_type, _1, type),
-                    message::parcel(message, params)));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                message::message::to_type, 
+                type,
+                message,
+                params);
     
-        message_manager.add_message(new_message);
+        post_message(new_message);
     }
   
-    bool returns_true(ptr controller) {return true;}
-  
     void manager::send_message_to_all(abstract_interface* sender, 
                                         const message::parcel& message)
     {
         if(!sender) return;
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(sender, 
-                    returns_true,
-                    message));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                message::message::to_all, 
+                std::string(),
+                message);
     
-        message_manager.add_message(new_message);
+        post_message(new_message);
     }
 
-    message::parcel& manager::send_message_to_all(abstract_interface* sender,
+    manager::message_builder manager::send_message_to_all(abstract_interface* sender,
                                         const parameter& message)
     {                
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    returns_true,
-                    message::parcel(message)));
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                message::message::to_all, 
+                std::string(),
+                message,
+                parameter_list());
     
-        message_manager.add_message(new_message);
-        return new_message->message_parcel;
+        return message_builder(this, new_message);
     }
 
     void manager::send_message_to_all(abstract_interface* sender,
@@ -398,14 +751,15 @@ namespace controller
     {
         if(!sender) return;
 
-        using namespace boost;        
-        message::ptr new_message(
-                new message::message(
-                    sender, 
-                    returns_true,
-                    message::parcel(message,params)));
-    
-        message_manager.add_message(new_message);    
+        message::ptr new_message = boost::allocate_shared<message::message>(
+                message::allocator(),
+                sender, 
+                message::message::to_all, 
+                std::string(),
+                message,
+                params);
+    
+        post_message(new_message);    
     }
 }//namespace controller
 }//namespace ncc
@@ -44,6 +44,16 @@ namespace message
         }
 		return false;
     }
+
+    double parcel::wake_time() const
+    {
+        return type == conditional && condition ? condition->wake_time() : 0;
+    }
+
+    double parcel::poll_interval() const
+    {
+        return type == conditional && condition ? condition->poll_interval() : 0;
+    }
 }//namespace message
 }//namespace controller
 }//namespace ncc
@@ -30,70 +30,240 @@
  */
 
 #include "controller/message_manager.h"
+#include "controller/controller_manager.h"
 namespace ncc {
 namespace controller {
 namespace message 
 {
     void manager::add_message(ptr& msg)
     {
-        if(msg) messages.push_back(msg);
+        if(!msg) return;
+        if(keep_statistics)
+        {
+            ++current.added;
+            msg->added_time = monotonic_seconds();
+        }
+
+        if(double wake_time = msg->message_parcel.wake_time()) 
+            schedule_message(msg, wake_time);
+        else if(msg->message_parcel.poll_interval() > 0) 
+            schedule_message(msg, monotonic_seconds());
+        else 
+            messages.push_back(msg);
+    }
+
+    void manager::post_message(const ptr& msg)
+    {
+        if(!msg) return;
+        //the queue holds a raw pointer so the message holds itself.
+        msg->posted = msg;
+        posted.push(msg.get());
+    }
+
+    void manager::add_posted_messages()
+    {
+        while(message* posted_message = posted.pop())
+        {
+            ptr msg;
+            msg.swap(posted_message->posted);
+            add_message(msg);
+            if(keep_statistics) ++current.posted;
+        }
     }
 
-    inline void handle_message(controller::ptr& recipient, controller::abstract_interface* sender, const parameter& msg, const parameter_list& params)
+    manager::~manager()
     {
-        if(recipient && sender) recipient->handle_message(msg, params, *sender);
+        while(message* posted_message = posted.pop())
+            posted_message->posted.reset();
     }
 
-    void send_message_to(controller::ptr& recipient, ptr* msg)
+    void manager::schedule_message(const ptr& msg, double time)
     {
-        using namespace boost;
+        scheduled_message entry = {time, schedule_count++, msg};
+        schedule.push(entry);
+    }
+
+    void manager::wake_messages()
+    {
+        if(schedule.empty()) return;
 
-        //now we call the callback is_recipient to determine if the current controller is
-        //a recipient of the message.
-        if((*msg)->is_recipient(recipient))
+        const double now = monotonic_seconds();
+        while(!schedule.empty() && schedule.top().time <= now)
         {
-            handle_message(
-                    recipient, 
-                    (*msg)->from, 
-                    (*msg)->message_parcel.message, 
-                    (*msg)->message_parcel.parameters);
+            ptr msg = schedule.top().msg;
+            schedule.pop();
+            if(keep_statistics) ++current.checked;
 
-            (*msg)->sent = true;
+            if(msg->message_parcel.send()) 
+            {
+                messages.push_back(msg);
+                continue;
+            }
+
+            //the message is not ready so it is checked again later. If the 
+            //condition has no interval it is checked every time like any
+            //other message.
+            const double interval = msg->message_parcel.poll_interval();
+            const double wake_time = msg->message_parcel.wake_time();
+            if(wake_time > now) schedule_message(msg, wake_time);
+            else if(interval > 0) schedule_message(msg, now + interval);
+            else messages.push_back(msg);
         }
     }
 
-    bool send_message(controller::ptr& controller, std::vector<ptr*>& messages)
+    inline void handle_message(controller::abstract_interface& recipient, controller::abstract_interface* sender, const parameter& msg, const parameter_list& params)
+    {
+        if(!sender) return;
+        //a message wakes a sleeping controller.
+        recipient.wake();
+        recipient.handle_message(msg, params, *sender);
+    }
+
+    template <class index_type>
+    std::size_t add_recipients(index_type& index, const std::string& key, std::vector<handle>& recipients)
+    {
+        typename index_type::iterator bucket = index.find(key);
+        if(bucket == index.end()) return 0;
+
+        typename index_type::mapped_type::iterator end = bucket->second.end();
+        for(typename index_type::mapped_type::iterator recipient = bucket->second.begin(); recipient != end; ++recipient)
+            recipients.push_back(recipient->second);
+        return bucket->second.size();
+    }
+
+    bool add_recipient(controller::ptr& recipient, std::vector<handle>& recipients)
     {
-        std::for_each(messages.begin(), messages.end(), boost::bind(send_message_to, boost::ref(controller), _1));
+        recipients.push_back(recipient->get_handle());
         return true;
     }
 
+    std::size_t manager::find_recipients(controller::manager& controllers, message& msg)
+    {
+        switch(msg.route)
+        {
+            case message::to_controller: 
+                if(controllers.get_controller(msg.recipient)) recipients.push_back(msg.recipient);
+                //if the recipient no longer exists then the message cannot be sent.
+                else 
+                {
+                    msg.sent = true;
+                    if(keep_statistics) ++current.dropped;
+                }
+                return 1;
+            case message::to_name: return add_recipients(controllers.name_index, msg.target, recipients);
+            case message::to_type: return add_recipients(controllers.type_index, msg.target, recipients);
+            case message::to_all:
+                tree::transverse_depth_first(controllers.root_controller, 
+                        boost::bind<bool>(add_recipient, _1, boost::ref(recipients)));
+                return recipients.size();
+        }
+        return 0;
+    }
+
+    void manager::count_delivery(const message& msg, double now)
+    {
+        ++current.sent;
+        current.deliveries += recipients.size();
+        stats.count_message(msg.message_parcel.message);
+
+        //a message added before statistics were enabled has no time.
+        if(!msg.added_time) return;
+        if(msg.message_parcel.is_conditional()) stats.condition_wait.add(now - msg.added_time);
+        else stats.delivery_latency.add(now - msg.added_time);
+    }
+
+    void manager::end_frame(double start)
+    {
+        current.scheduled = schedule.size();
+        current.seconds = monotonic_seconds() - start;
+        stats.last = current;
+        stats.total += current;
+        ++stats.frames;
+        current.clear();
+    }
+
     bool message_sent(ptr& msg)
     {
         if(!msg->from) return true;   //if the sender no longer exists then the message cannot be sent.
         return msg->sent;                  
     }
 
-    void add_ready_message(ptr& msg, std::vector<ptr*>& messages)
+    void manager::send_messages(controller::manager& controllers)
     {
-        if(msg->message_parcel.send()) messages.push_back(&msg);
-    }	
+        const double start = keep_statistics ? monotonic_seconds() : 0;
+        add_posted_messages();
+        wake_messages();
+        deliver_messages(controllers);
+        if(keep_statistics) end_frame(start);
+    }
 
-    void manager::send_messages(controller::ptr& root)
+    void manager::deliver_messages(controller::manager& controllers)
     {
         if(messages.empty()) return;
+        const double now = keep_statistics ? monotonic_seconds() : 0;
+        if(keep_statistics) current.pending = messages.size();
+
+        ++delivery_round;
+
+        //only the messages in the queue now are sent. Messages added by a 
+        //recipient's handle_message are sent on the next call.
+        message_list::size_type count = messages.size();
+        message_list::iterator msg = messages.begin();
+        for(; count > 0; --count, ++msg)
+        {
+            //skip messages that are not ready to be sent
+            if(keep_statistics) ++current.checked;
+            if(!(*msg)->message_parcel.send()) continue;
+
+            //the recipients are gathered before any are sent the message 
+            //because handle_message may add, rename, or remove controllers.
+            recipients.clear();
+            const std::size_t visited = find_recipients(controllers, **msg);
+            if(keep_statistics)
+            {
+                current.visited += visited;
+                if(!recipients.empty() && (*msg)->from) count_delivery(**msg, now);
+            }
 
-        //filter messages that are not ready to be sent
-        std::vector<ptr*> ready_messages;
-        ready_messages.reserve(messages.size());
-        std::for_each(messages.begin(), messages.end(), boost::bind(add_ready_message, _1, ref(ready_messages)));
-        if(ready_messages.empty()) return;
+            std::vector<handle>::iterator end = recipients.end();
+            for(std::vector<handle>::iterator recipient_handle = recipients.begin(); recipient_handle != end; ++recipient_handle)
+            {
+                abstract_interface* recipient = controllers.get_controller(*recipient_handle);
+                if(!recipient) continue;
 
-        //transverse tree and send ready messages
-        tree::transverse_depth_first(root, boost::bind<bool>(send_message, _1, boost::ref(ready_messages)));
+                handle_message(
+                        *recipient, 
+                        (*msg)->from, 
+                        (*msg)->message_parcel.message, 
+                        (*msg)->message_parcel.parameters);
+                (*msg)->sent = true;
 
-        //erase all messages that were sent
-        messages.remove_if(message_sent);
+                if(recipient->delivery_round != delivery_round)
+                {
+                    recipient->delivery_round = delivery_round;
+                    delivered.push_back(*recipient_handle);
+                }
+            }
+        }
+        recipients.clear();
+
+        //called before the sent messages are erased so that controllers 
+        //which queued them can still use them.
+        if(keep_statistics) current.recipients = delivered.size();
+        std::vector<handle>::iterator delivered_end = delivered.end();
+        for(std::vector<handle>::iterator recipient = delivered.begin(); recipient != delivered_end; ++recipient)
+            if(abstract_interface* delivered_to = controllers.get_controller(*recipient)) 
+                delivered_to->messages_delivered();
+        delivered.clear();
+
+        //erase all messages that were sent. A message erased before it was 
+        //sent is dropped because its sender is gone.
+        for(message_list::iterator msg = messages.begin(); msg != messages.end();)
+        {
+            if(!message_sent(*msg)) { ++msg; continue;}
+            if(keep_statistics && !(*msg)->sent) ++current.dropped;
+            msg = messages.erase(msg);
+        }
     }
 }//namespace message
 }//namespace controller
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#include "controller/message_stats.h"
+#include "controller/typed_message.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace ncc {
+namespace controller {
+namespace message 
+{
+    void latency_histogram::add(double seconds)
+    {
+        unsigned int index = 0;
+        double limit = bucket_limit(0);
+        while(seconds > limit && index < bucket_count - 1)
+        {
+            limit *= 2;
+            ++index;
+        }
+        ++buckets[index];
+        ++samples;
+        total += seconds;
+        longest = std::max(longest, seconds);
+    }
+
+    void latency_histogram::clear()
+    {
+        std::fill(buckets, buckets + bucket_count, 0);
+        samples = 0;
+        total = 0;
+        longest = 0;
+    }
+
+    double latency_histogram::bucket_limit(unsigned int index)
+    {
+        double limit = 0.000001;
+        for(; index > 0; --index) limit *= 2;
+        return limit;
+    }
+
+    double latency_histogram::percentile(double fraction) const
+    {
+        if(samples == 0) return 0;
+
+        const double wanted = fraction * samples;
+        unsigned long counted = 0;
+        for(unsigned int index = 0; index < bucket_count; ++index)
+        {
+            counted += buckets[index];
+            if(counted >= wanted && counted > 0) 
+                return std::min(bucket_limit(index), longest);
+        }
+        return longest;
+    }
+
+    void statistics::frame::clear()
+    {
+        added = posted = pending = scheduled = checked = 0;
+        sent = dropped = deliveries = recipients = visited = 0;
+        seconds = 0;
+    }
+
+    statistics::frame& statistics::frame::operator += (const frame& other)
+    {
+        added += other.added;
+        posted += other.posted;
+        pending += other.pending;
+        scheduled += other.scheduled;
+        checked += other.checked;
+        sent += other.sent;
+        dropped += other.dropped;
+        deliveries += other.deliveries;
+        recipients += other.recipients;
+        visited += other.visited;
+        seconds += other.seconds;
+        return *this;
+    }
+
+    void statistics::clear()
+    {
+        last.clear();
+        total.clear();
+        frames = 0;
+        delivery_latency.clear();
+        condition_wait.clear();
+        named.clear();
+        typed.clear();
+        untyped = 0;
+    }
+
+    void statistics::count_message(const parameter& message)
+    {
+        if(const std::string* name = message.cast<std::string>()) ++named[*name];
+        else if(unsigned int id = message.id()) ++typed[id];
+        else ++untyped;
+    }
+
+    bool more_messages(const statistics::name_count& lhs, const statistics::name_count& rhs)
+    {
+        return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+    }
+
+    statistics::name_count_list statistics::top_messages(std::size_t count) const
+    {
+        name_count_list counts(named.begin(), named.end());
+        for(id_map::const_iterator entry = typed.begin(); entry != typed.end(); ++entry)
+        {
+            std::string name;
+            if(!script_name(entry->first, name))
+            {
+                std::ostringstream id;
+                id << "(typed message " << entry->first << ")";
+                name = id.str();
+            }
+            counts.push_back(name_count(name, entry->second));
+        }
+        if(untyped) counts.push_back(name_count("(untyped)", untyped));
+
+        count = std::min(count, counts.size());
+        std::partial_sort(counts.begin(), counts.begin() + count, counts.end(), more_messages);
+        counts.resize(count);
+        return counts;
+    }
+
+    void write_frame(std::ostream& out, const char* title, const statistics::frame& counters, double frames)
+    {
+        if(frames <= 0) frames = 1;
+        out << title << "\n" 
+            << "  added       " << counters.added / frames << "\n"
+            << "  posted      " << counters.posted / frames << "\n"
+            << "  pending     " << counters.pending / frames << "\n"
+            << "  scheduled   " << counters.scheduled / frames << "\n"
+            << "  checked     " << counters.checked / frames << "\n"
+            << "  sent        " << counters.sent / frames << "\n"
+            << "  dropped     " << counters.dropped / frames << "\n"
+            << "  deliveries  " << counters.deliveries / frames << "\n"
+            << "  recipients  " << counters.recipients / frames << "\n"
+            << "  visited     " << counters.visited / frames << "\n"
+            << "  milliseconds " << counters.seconds * 1000 / frames << "\n";
+    }
+
+    void write_histogram(std::ostream& out, const char* title, const latency_histogram& histogram)
+    {
+        out << title << " (" << histogram.count() << " messages)\n"
+            << "  mean " << histogram.mean() * 1000 << " ms"
+            << ", p50 " << histogram.percentile(0.5) * 1000 << " ms"
+            << ", p90 " << histogram.percentile(0.9) * 1000 << " ms"
+            << ", p99 " << histogram.percentile(0.99) * 1000 << " ms"
+            << ", max " << histogram.max() * 1000 << " ms\n";
+
+        for(unsigned int index = 0; index < latency_histogram::bucket_count; ++index)
+            if(histogram.bucket(index))
+                out << "  <= " << std::setw(12) << latency_histogram::bucket_limit(index) * 1000 
+                    << " ms " << histogram.bucket(index) << "\n";
+    }
+
+    void statistics::write(std::ostream& out, std::size_t top) const
+    {
+        out << "message statistics over " << frames << " frames\n";
+        write_frame(out, "last frame", last, 1);
+        write_frame(out, "average frame", total, frames);
+        write_histogram(out, "delivery latency", delivery_latency);
+        write_histogram(out, "condition wait", condition_wait);
+
+        name_count_list counts = top_messages(top);
+        out << "top messages\n";
+        for(name_count_list::iterator entry = counts.begin(); entry != counts.end(); ++entry)
+            out << "  " << std::setw(10) << entry->second << " " << entry->first << "\n";
+    }
+
+    bool statistics::dump(const std::string& file_name, std::size_t top) const
+    {
+        std::ofstream file(file_name.c_str());
+        if(!file) return false;
+        write(file, top);
+        return file.good();
+    }
+}//namespace message
+}//namespace controller
+}//namespace ncc
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+#include "controller/typed_message.h"
+#include <vector>
+#ifdef WIN32
+	#include <map>
+#else
+	#include <tr1/unordered_map>
+	#include <boost/functional/hash.hpp>
+#endif
+
+namespace ncc {
+namespace controller {
+namespace message
+{
+    namespace
+    {
+        struct script_message
+        {
+            std::string name;
+            to_script_function to_script;
+            from_script_function from_script;
+        };
+
+#ifdef WIN32
+        typedef std::map<std::string, unsigned int> name_map;
+#else
+        typedef std::tr1::unordered_map<std::string, unsigned int, boost::hash<std::string> > name_map;
+#endif
+        ///The script messages indexed by id.
+        std::vector<script_message>& script_messages()
+        {
+            static std::vector<script_message> messages;
+            return messages;
+        }
+
+        ///The ids of the script messages by name.
+        name_map& script_names()
+        {
+            static name_map names;
+            return names;
+        }
+    }
+
+    void register_script_message(unsigned int id, 
+            const std::string& name, 
+            to_script_function to_script, 
+            from_script_function from_script)
+    {
+        if(id == 0 || name.empty()) return;
+
+        std::vector<script_message>& messages = script_messages();
+        if(messages.size() <= id) messages.resize(id + 1);
+        script_message entry = {name, to_script, from_script};
+        messages[id] = entry;
+        script_names()[name] = id;
+    }
+
+    bool to_script(const parameter& message, std::string& name, parameter_list& params)
+    {
+        const unsigned int id = message.id();
+        std::vector<script_message>& messages = script_messages();
+        if(id == 0 || id >= messages.size() || !messages[id].to_script) return false;
+
+        name = messages[id].name;
+        messages[id].to_script(message, params);
+        return true;
+    }
+
+    bool script_name(unsigned int id, std::string& name)
+    {
+        std::vector<script_message>& messages = script_messages();
+        if(id == 0 || id >= messages.size() || messages[id].name.empty()) return false;
+
+        name = messages[id].name;
+        return true;
+    }
+
+    bool from_script(const parameter& message, const parameter_list& params, parameter& typed)
+    {
+        //scripts name their messages with strings.
+        const std::string* name = message.cast<std::string>();
+        if(!name || script_names().empty()) return false;
+
+        name_map::iterator found = script_names().find(*name);
+        if(found == script_names().end()) return false;
+
+        return script_messages()[found->second].from_script(params, typed);
+    }
+}//namespace message
+}//namespace controller
+}//namespace ncc
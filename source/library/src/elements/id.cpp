@@ -32,8 +32,14 @@
 #include "elements/id.h"
 namespace ncc
 {
-    unsigned long id_type::previous_id = 1;
-    bool operator == (unsigned long lhs, id_type rhs)
+    boost::atomic<unsigned long> id_type::previous_id(1);
+
+    void id_type::create_id()
+    {
+        value = previous_id.fetch_add(1, boost::memory_order_relaxed);
+    }
+
+    bool operator == (unsigned long lhs, const id_type& rhs)
     {
         return lhs == rhs.get_id();
     }
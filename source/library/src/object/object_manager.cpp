@@ -29,6 +29,8 @@
  * also delete it here.
  */
 
+#include <functional>
+#include <boost/bind.hpp>
 #include "object/object_manager.h"
 namespace ncc {
 namespace object 
@@ -38,39 +40,123 @@ namespace object
         //we do not add a object if the object is null
         if(!object) return ptr();
 
-        //We insert an object and if the insert fails because it already exists we return a 0 pointer.
-        std::pair<object_set::iterator, bool> result = objects.insert(object);
-        if(result.second == false) return ptr();
+        //an object is in one manager at a time.
+        if(object->owner && !is_managed(object.get())) return ptr();
 
+        if(is_managed(object.get()))
+        {
+            //if the object already exists we return a 0 pointer.
+            if(handles.get(object->handle_holder)) return ptr();
+
+            //the object was removed during this step and is still in the 
+            //array, so it only has to be kept there.
+            removed_objects.erase(std::find(removed_objects.begin(), removed_objects.end(), object->manager_index));
+            object->handle_holder = handles.create(object.get());
+            return object;
+        }
+
+        object->owner = this;
+        object->manager_index = objects.size();
+        objects.push_back(object);
+        object->handle_holder = handles.create(object.get());
         return object;
     }
+
+    manager::~manager()
+    {
+        //the objects may outlive the manager and be added to another one.
+        for(object_array::iterator object = objects.begin(); object != objects.end(); ++object)
+        {
+            (*object)->owner = 0;
+            (*object)->handle_holder = handle();
+        }
+    }
     
     void manager::remove_object(weak_ptr& object_ptr)
     {			
-        object_set::iterator object_to_erase = objects.find(object_ptr.lock());
-        if(object_to_erase != objects.end())
-            objects.erase(object_to_erase);
+        if(ptr object = object_ptr.lock()) remove_object(object.get());
     }		
     
     void manager::remove_object(abstract_interface* object_ptr)
     {
-        object_set::iterator end = objects.end();
-        for(object_set::iterator object_to_erase = objects.begin(); object_to_erase != end; ++object_to_erase)
-            if(object_to_erase->get() == object_ptr)
-            { 
-                objects.erase(object_to_erase);
-                break;
-            }
+        if(!object_ptr || !is_managed(object_ptr)) return;
+
+        //an object removed during step is already gone if its handle is.
+        if(!handles.get(object_ptr->handle_holder)) return;
+        handles.release(object_ptr->handle_holder);
+        object_ptr->handle_holder = handle();
+
+        //while stepping the array must not move, so the object stays in it 
+        //until the step is over.
+        if(stepping) removed_objects.push_back(object_ptr->manager_index);
+        else erase_object(object_ptr->manager_index);
     }
-    
-    void update_object(const ptr& object)
+
+    void manager::erase_object(std::size_t index)
+    {
+        objects[index]->owner = 0;
+        //the last object fills the hole so the array stays packed.
+        if(index + 1 != objects.size())
+        {
+            objects[index].swap(objects.back());
+            objects[index]->manager_index = index;
+        }
+        objects.pop_back();
+    }
+
+    void manager::remove_object(const handle& object)
     {
-        object->update();
-    } 
+        if(abstract_interface* object_ptr = handles.get(object)) remove_object(object_ptr);
+    }
 
     void manager::step()
     {
-        for_each(objects.begin(), objects.end(), update_object);
+        stepping = true;
+        if(pool && objects.size() > 1)
+        {
+            //a few ranges per thread let the pool even out ranges which 
+            //take longer than others.
+            const std::size_t range_count = pool->size() * 4;
+            const std::size_t range_size = std::max<std::size_t>(64, (objects.size() + range_count - 1) / range_count);
+            for(std::size_t begin = 0; begin < objects.size(); begin += range_size)
+                range_tasks.push_back(boost::bind(&manager::update_physical, this, begin, std::min(begin + range_size, objects.size())));
+            pool->run(range_tasks);
+            range_tasks.clear();
+        }
+
+        //indexed so that an object added by an update does not invalidate 
+        //the loop. Objects added are updated in this step.
+        for(std::size_t index = 0; index < objects.size(); ++index)
+            if(is_stepped(index)) objects[index]->update();
+        stepping = false;
+        erase_removed_objects();
+    }
+
+    void manager::erase_removed_objects()
+    {
+        //the highest index is erased first, so the object which fills each
+        //hole is never one that is still to be erased.
+        std::sort(removed_objects.begin(), removed_objects.end(), std::greater<std::size_t>());
+        std::vector<std::size_t>::iterator end = removed_objects.end();
+        for(std::vector<std::size_t>::iterator index = removed_objects.begin(); index != end; ++index)
+            erase_object(*index);
+        removed_objects.clear();
+    }
+
+    void manager::update_physical(std::size_t begin, std::size_t end)
+    {
+        for(std::size_t index = begin; index < end; ++index)
+            objects[index]->update_physical();
+    }
+
+    void manager::enable_parallel_step(unsigned int threads)
+    {
+        pool.reset(new thread_pool(threads));
+    }
+
+    void manager::disable_parallel_step()
+    {
+        pool.reset();
     }
 }//namespace object
 }//namespace ncc
@@ -29,12 +29,64 @@
  * also delete it here.
  */
 
+#include <cmath>
 #include "object/ode/ode_manager.h"
 #include "object/ode/ode_policies.h"
 namespace ncc {
 namespace ode
 {
-    manager::manager(double erp, double cfm) : ERP(erp), CFM(cfm)
+    int level_of(double size)
+    {
+        return static_cast<int>(std::ceil(std::log(std::max(size, 1e-6)) / std::log(2.0)));
+    }
+
+    space_settings space_settings::fit(space_type space, 
+            double min_x, double min_y, double min_z, 
+            double max_x, double max_y, double max_z,
+            double cell_size)
+    {
+        space_settings settings(space);
+        settings.center[0] = (min_x + max_x) / 2.0;
+        settings.center[1] = (min_y + max_y) / 2.0;
+        settings.center[2] = (min_z + max_z) / 2.0;
+        settings.extents[0] = max_x - min_x;
+        settings.extents[1] = max_y - min_y;
+        settings.extents[2] = max_z - min_z;
+
+        const double size = std::max(settings.extents[0], std::max(settings.extents[1], settings.extents[2]));
+        settings.min_level = level_of(cell_size);
+        settings.max_level = std::max(settings.min_level, level_of(size));
+        //the quadtree halves the bounds on each level until the cells are 
+        //about as big as an object. ODE allocates every cell up front, so 
+        //the depth is kept to the 10 levels the default uses.
+        settings.depth = std::max(1, std::min(10, level_of(size / cell_size)));
+        return settings;
+    }
+
+    dSpaceID create_space(const space_settings& settings)
+    {
+        switch(settings.type)
+        {
+            case space_settings::simple:
+                return dSimpleSpaceCreate(0);
+            case space_settings::hash:
+            {
+                dSpaceID space = dHashSpaceCreate(0);
+                dHashSpaceSetLevels(space, settings.min_level, settings.max_level);
+                return space;
+            }
+            case space_settings::sweep_and_prune:
+                return dSweepAndPruneSpaceCreate(0, dSAP_AXES_XYZ);
+            default:
+            {
+                dVector3 center = {settings.center[0], settings.center[1], settings.center[2]};
+                dVector3 extends = {settings.extents[0], settings.extents[1], settings.extents[2]};
+                return dQuadTreeSpaceCreate(0, center, extends, settings.depth);
+            }
+        }
+    }
+
+    manager::manager(double erp, double cfm, const space_settings& space) : ERP(erp), CFM(cfm), table_width(0)
     {
         dInitODE();
         world_id = dWorldCreate();
@@ -50,13 +102,124 @@ namespace ode
         dWorldSetContactSurfaceLayer (world_id,0.1);
 
         //Create a collision world and collision geometry objects, as necessary.
-        dVector3 center = {0,0,0};
-        dVector3 extends = {500, 500, 500};
-        space_id = dQuadTreeSpaceCreate(0,center,extends,10);
-     //   space_id = dSimpleSpaceCreate(0);
+        space_id = create_space(space);
+        static_space_id = create_space(space);
+
+        //the query geoms are in no space so they are never stepped.
+        ray_geom = dCreateRay(0, 1);
+        sphere_geom = dCreateSphere(0, 1);
+        box_geom = dCreateBox(0, 1, 1, 1);
         //Create a joint group to hold the contact joints.
        contact_group_id = dJointGroupCreate(0);
 
+        //the default material of ncc::ode::object_material, which is never
+        //released.
+        get_material(0.0, 0.0);
+    }
+
+    dSurfaceParameters create_surface(double friction, double bounce)
+    {
+        dSurfaceParameters surface;
+        surface.mode = dContactBounce | dContactSoftCFM;
+        surface.mu = friction == -1 ? dInfinity : friction;
+        surface.mu2 = surface.mu;
+        surface.bounce = bounce;
+        surface.bounce_vel = 0.01;
+        surface.soft_cfm = 0.001;
+        return surface;
+    }
+
+    //the surface of a pair of materials which was not set.
+    dSurfaceParameters default_surface(const std::pair<double, double>& first, const std::pair<double, double>& second)
+    {
+        return create_surface(std::sqrt(first.first * second.first), (first.second + second.second) / 2.0);
+    }
+
+    material_id manager::get_material(double friction, double bounce)
+    {
+        const material_key key(friction, bounce);
+        material_map::iterator existing = material_index.find(key);
+        if(existing != material_index.end()) 
+        {
+            ++material_uses[existing->second];
+            return existing->second;
+        }
+
+        //the smallest free id is reused so that the table stays full.
+        material_id added = materials.size();
+        if(!free_materials.empty())
+        {
+            added = *free_materials.begin();
+            free_materials.erase(free_materials.begin());
+            materials[added] = key;
+            material_uses[added] = 1;
+        }
+        else
+        {
+            materials.push_back(key);
+            material_uses.push_back(1);
+        }
+        material_index.insert(std::make_pair(key, added));
+        fill_surfaces(added);
+        return added;
+    }
+
+    void manager::fill_surfaces(material_id added)
+    {
+        if(added >= max_table_materials) return;
+
+        //the table is rebuilt with a row and column for a new material. 
+        //The surfaces of the old pairs are kept since they may have been set.
+        if(added >= table_width)
+        {
+            const std::size_t count = added + 1;
+            std::vector<dSurfaceParameters> resized(count * count);
+            for(material_id first = 0; first < table_width; ++first)
+                std::copy(surfaces.begin() + first * table_width, surfaces.begin() + (first + 1) * table_width, resized.begin() + first * count);
+            surfaces.swap(resized);
+            table_width = count;
+        }
+        for(material_id other = 0; other < table_width; ++other)
+        {
+            const dSurfaceParameters surface = default_surface(materials[added], materials[other]);
+            surfaces[added * table_width + other] = surface;
+            surfaces[other * table_width + added] = surface;
+        }
+    }
+
+    void manager::release_material(material_id material)
+    {
+        if(material >= materials.size() || !material_uses[material]) return;
+        if(--material_uses[material]) return;
+
+        material_index.erase(materials[material]);
+        free_materials.insert(material);
+        //the surfaces set for the material do not apply to the next one 
+        //with its id. Those in the table are reset when the id is reused.
+        for(surface_map::iterator entry = pair_surfaces.begin(); entry != pair_surfaces.end();)
+        {
+            if(entry->first.first == material || entry->first.second == material) pair_surfaces.erase(entry++);
+            else ++entry;
+        }
+    }
+
+    void manager::set_material_pair(material_id first, material_id second, double friction, double bounce)
+    {
+        if(first >= materials.size() || second >= materials.size()) return;
+        const dSurfaceParameters surface = create_surface(friction, bounce);
+        if(first < table_width && second < table_width)
+        {
+            surfaces[first * table_width + second] = surface;
+            surfaces[second * table_width + first] = surface;
+        }
+        else pair_surfaces[std::make_pair(std::min(first, second), std::max(first, second))] = surface;
+    }
+
+    dSurfaceParameters manager::pair_surface(material_id first, material_id second) const
+    {
+        surface_map::const_iterator set = pair_surfaces.find(std::make_pair(std::min(first, second), std::max(first, second)));
+        if(set != pair_surfaces.end()) return set->second;
+        return default_surface(materials[first], materials[second]);
     }
     
     void near_callback (void* mgr, dGeomID o1, dGeomID o2)
@@ -71,106 +234,280 @@ namespace ode
         dBodyID b2 = dGeomGetBody(o2);
         if (b1 && b2 && dAreConnectedExcluding (b1,b2,dJointTypeContact)) return;
 
-        //now get a pointer to the objects stored in the geom data pointer
-        object* object_1 =  reinterpret_cast<object*>(dGeomGetData(o1));
-        object* object_2 =  reinterpret_cast<object*>(dGeomGetData(o2));
+        //now get the objects stored in the geom data pointer
+        const geom_data* data_1 = reinterpret_cast<const geom_data*>(dGeomGetData(o1));
+        const geom_data* data_2 = reinterpret_cast<const geom_data*>(dGeomGetData(o2));
         
         //if we could not get the objects then return
-        if(!object_1 || !object_2)
+        if(!data_1 || !data_2)
             return;
     
-        const double o1_friction = object_1->get_friction();
-        const double o2_friction = object_2->get_friction();
-        const double friction = std::sqrt(o1_friction * o2_friction);
-        const double bounce = (object_2->get_bounce() + object_1->get_bounce()) / 2.0;
-    
+        //dCollide only writes the contact geometry, the surface is set 
+        //below for the contacts it returned.
         dContact contact[MAX_CONTACTS];   
-        dContact object_contact;
-        
-        object_contact.surface.mode = dContactBounce | dContactSoftCFM;
-        object_contact.surface.mu = friction == -1 ? dInfinity : friction;
-        object_contact.surface.mu2 = object_contact.surface.mu;
-        object_contact.surface.bounce = bounce;
-        object_contact.surface.bounce_vel = 0.01;
-        object_contact.surface.soft_cfm = 0.001;
-
-        for (i=0; i<MAX_CONTACTS; i++) 
-            contact[i] = object_contact;
-        
-        if (int numc = dCollide (o1,o2,MAX_CONTACTS,&contact[0].geom,sizeof(dContact))) 
-        {
-			collision_callback& callback1 = object_1->callback();
-			collision_callback& callback2 = object_2->callback();
-			collision_info collision1 = { 0,dynamic_cast<ncc::object::abstract_interface*>(object_1), dynamic_cast<ncc::object::abstract_interface*>(object_2)};
-			collision_info collision2 = { 0, dynamic_cast<ncc::object::abstract_interface*>(object_2), dynamic_cast<ncc::object::abstract_interface*>(object_1)};
-			bool create_joints;
-			if(callback1  && callback2)
-			{
-				bool col1 = callback1(collision1);
-				bool col2 = callback2(collision2);
-				create_joints = col1 || col2;
-			}
-			else if(callback1 && !callback2)
-				create_joints = callback1(collision1);
-			else if(callback2 && !callback1)
-				create_joints = callback2(collision2);
-			else
-				create_joints = true;
-			
-			if(create_joints)
-				for (i=0; i<numc; i++) 
-				{
-					dJointID c = dJointCreateContact (ode_manager->ode_world(),ode_manager->contact_group(),&contact[i]);
-					dJointAttach (c,b1,b2);
-				}
-        }
-    }
-
-
-	struct ray_contact_holder
-	{
-		double contact_depth;
-		ode::object* contact_object;
-	};
-
-	void near_ray_callback(void* ray_contact_ptr,  dGeomID o1, dGeomID o2)
-	{
-		dContact contact;
-		
-		if(ray_contact_holder* ray_contact= reinterpret_cast<ray_contact_holder*>(ray_contact_ptr))
-		{	
-			
-			if( dCollide( o2, o1, 1, &contact.geom, sizeof(contact) ) == 1 ) 
-			{			
-				if( contact.geom.depth < ray_contact->contact_depth) 
-				{					
-					ray_contact->contact_depth = contact.geom.depth;
-					ray_contact->contact_object = reinterpret_cast<ode::object*>(dGeomGetData(o2));					 
-				}
-			}
-		}
-	}
+        const int numc = dCollide (o1,o2,MAX_CONTACTS,&contact[0].geom,sizeof(dContact));
+        if(!numc) return;
+
+        //the callbacks are called after the step, only their collisions 
+        //are recorded here.
+        if(data_1->owner->callback() || data_2->owner->callback())
+            if(!ode_manager->record_collision(data_1, data_2, contact, numc)) return;
+
+        //objects which are not solid are only told about their collisions.
+        if(!data_1->solid || !data_2->solid) return;
+
+        const dSurfaceParameters surface = ode_manager->get_surface(data_1->material, data_2->material);
+        for (i=0; i<numc; i++) 
+        {
+            contact[i].surface = surface;
+            dJointID c = dJointCreateContact (ode_manager->ode_world(),ode_manager->contact_group(),&contact[i]);
+            dJointAttach (c,b1,b2);
+        }
+    }
+
+
+    bool manager::record_collision(const geom_data* geom_1, const geom_data* geom_2, const dContact* contacts, int count)
+    {
+        //the deepest contact describes the collision.
+        const dContactGeom* deepest = &contacts[0].geom;
+        for(int index = 1; index < count; ++index)
+            if(contacts[index].geom.depth > deepest->depth) deepest = &contacts[index].geom;
+
+        //the normal is flipped when the geoms are swapped so that it stays
+        //as seen by geom_1.
+        const bool swapped = geom_2 < geom_1;
+        const double sign = swapped ? -1.0 : 1.0;
+        if(swapped) std::swap(geom_1, geom_2);
+
+        collision_record record;
+        record.key_1 = record.geom_1 = geom_1;
+        record.key_2 = record.geom_2 = geom_2;
+        record.ignored = false;
+
+        collision_info& info = record.info;
+        info.depth = deepest->depth;
+        info.object_1 = geom_1->object_interface;
+        info.object_2 = geom_2->object_interface;
+        info.state = collision_info::contact_begin;
+        dVector3 velocity_1 = {0, 0, 0, 0};
+        dVector3 velocity_2 = {0, 0, 0, 0};
+        if(dBodyID body = geom_1->owner->get_ode_body()) dBodyGetPointVel(body, deepest->pos[0], deepest->pos[1], deepest->pos[2], velocity_1);
+        if(dBodyID body = geom_2->owner->get_ode_body()) dBodyGetPointVel(body, deepest->pos[0], deepest->pos[1], deepest->pos[2], velocity_2);
+        info.relative_speed = 0;
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            info.position[axis] = deepest->pos[axis];
+            info.normal[axis] = sign * deepest->normal[axis];
+            info.relative_speed += (velocity_2[axis] - velocity_1[axis]) * info.normal[axis];
+        }
+
+        //a pair whose callbacks declined contact joints passes through until 
+        //the objects stop touching.
+        collision_list::iterator previous = std::lower_bound(touching.begin(), touching.end(), record, earlier_pair);
+        if(previous != touching.end() && !earlier_pair(record, *previous) && previous->geom_1 && previous->geom_2)
+            record.ignored = previous->ignored;
+
+        collisions.push_back(record);
+        return !record.ignored;
+    }
+
+    void manager::deliver_collisions()
+    {
+        std::sort(collisions.begin(), collisions.end(), earlier_pair);
+
+        //both lists are sorted so a merge finds the collisions which began,
+        //persisted, and ended. Callbacks may destroy objects, which only 
+        //clears geoms in the lists, so indexes stay valid.
+        std::size_t previous = 0;
+        for(std::size_t current = 0; current < collisions.size(); ++current)
+        {
+            for(; previous < touching.size() && earlier_pair(touching[previous], collisions[current]); ++previous)
+                deliver_collision(touching[previous], collision_info::contact_end);
+
+            collision_info::collision_state state = collision_info::contact_begin;
+            if(previous < touching.size() && !earlier_pair(collisions[current], touching[previous]))
+            {
+                if(touching[previous].geom_1 && touching[previous].geom_2) state = collision_info::contact_persist;
+                ++previous;
+            }
+            deliver_collision(collisions[current], state);
+        }
+        for(; previous < touching.size(); ++previous)
+            deliver_collision(touching[previous], collision_info::contact_end);
+
+        touching.swap(collisions);
+        collisions.clear();
+    }
+
+    void manager::deliver_collision(collision_record& record, collision_info::collision_state state)
+    {
+        if(!record.geom_1 || !record.geom_2) return;
+        record.info.state = state;
+
+        collision_info flipped = record.info;
+        std::swap(flipped.object_1, flipped.object_2);
+        for(int axis = 0; axis < 3; ++axis) flipped.normal[axis] = -flipped.normal[axis];
+
+        //a pair creates contact joints if any of its callbacks asks for them.
+        bool called = false;
+        bool create_joints = false;
+        if(record.geom_1->owner->callback())
+        {
+            create_joints = record.geom_1->owner->callback()(record.info) || create_joints;
+            called = true;
+        }
+        //the first callback may have destroyed the other object.
+        if(record.geom_2 && record.geom_2->owner->callback())
+        {
+            create_joints = record.geom_2->owner->callback()(flipped) || create_joints;
+            called = true;
+        }
+        record.ignored = called && !create_joints;
+    }
+
+    void manager::clear_collisions()
+    {
+        collisions.clear();
+    }
+
+    void manager::forget_collisions(const geom_data* geom)
+    {
+        for(collision_list::iterator record = collisions.begin(); record != collisions.end(); ++record)
+        {
+            if(record->geom_1 == geom) record->geom_1 = 0;
+            if(record->geom_2 == geom) record->geom_2 = 0;
+        }
+        for(collision_list::iterator record = touching.begin(); record != touching.end(); ++record)
+        {
+            if(record->geom_1 == geom) record->geom_1 = 0;
+            if(record->geom_2 == geom) record->geom_2 = 0;
+        }
+    }
+
+    ///The state of a query passed to near_query_callback.
+    struct query_state
+    {
+        dGeomID geom;
+        manager::query_mode mode;
+        query_hit* hit; ///< the hit of a ray.
+        query_hit_list* hits; ///< the hits of an overlap, 0 for a ray.
+    };
+
+    void set_hit(query_hit& hit, const geom_data* data, const dContactGeom& contact)
+    {
+        hit.hit_object = data->owner;
+        hit.object_interface = data->object_interface;
+        hit.depth = contact.depth;
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            hit.position[axis] = contact.pos[axis];
+            hit.normal[axis] = contact.normal[axis];
+        }
+    }
+
+    void near_query_callback(void* state_ptr, dGeomID o1, dGeomID o2)
+    {
+        query_state* state = reinterpret_cast<query_state*>(state_ptr);
+        const dGeomID other = o1 == state->geom ? o2 : o1;
+        const geom_data* data = reinterpret_cast<const geom_data*>(dGeomGetData(other));
+        if(!data) return;
+
+        //ODE cannot stop a collide early, so the rest of an any hit query 
+        //returns here.
+        if(!state->hits && state->mode == manager::any_hit && state->hit->hit_object) return;
+
+        dContactGeom contact;
+        if(dCollide(state->geom, other, 1, &contact, sizeof(contact)) != 1) return;
+
+        if(state->hits)
+        {
+            state->hits->push_back(query_hit());
+            set_hit(state->hits->back(), data, contact);
+        }
+        else if(!state->hit->hit_object || contact.depth < state->hit->depth)
+            set_hit(*state->hit, data, contact);
+    }
+
+    void manager::query(dGeomID geom, query_mode mode, unsigned long mask, query_hit* hit, query_hit_list* hits)
+    {
+        //the query belongs to no category so only the mask decides what it
+        //is tested against.
+        dGeomSetCategoryBits(geom, 0);
+        dGeomSetCollideBits(geom, mask);
+        query_state state = { geom, mode, hit, hits};
+        dSpaceCollide2(geom, reinterpret_cast<dGeomID>(space_id), reinterpret_cast<void*>(&state), near_query_callback);
+        if(mode == any_hit && hit && hit->hit_object) return;
+        dSpaceCollide2(geom, reinterpret_cast<dGeomID>(static_space_id), reinterpret_cast<void*>(&state), near_query_callback);
+    }
+
 	double manager::ray_cast(double origin_x, double origin_y, double origin_z, 
 							double direction_x, double direction_y, double direction_z, 
 							double length, ode::object** obj)
 	{		
-		ray_contact_holder ray_contact = { 1e10, 0};		
-		dGeomID ray = dCreateRay(0, length);		
-		dGeomRaySet(ray, origin_x, origin_y, origin_z, direction_x, direction_y, direction_z );
-		dSpaceCollide2( ray, reinterpret_cast<dGeomID>(space_id), reinterpret_cast<void*>(&ray_contact), near_ray_callback );		
-		(*obj) = ray_contact.contact_object;			
-		dGeomDestroy(ray);
-		return ray_contact.contact_depth;
+		const ray_query ray = { {origin_x, origin_y, origin_z}, {direction_x, direction_y, direction_z}, length};
+		query_hit hit;
+		cast_ray(ray, closest_hit, ~0ul, hit);
+		(*obj) = hit.hit_object;
+		return hit.hit_object ? hit.depth : 1e10;
 	}
 
+    void manager::ray_cast(const ray_query_list& rays, query_hit_list& hits, query_mode mode, unsigned long mask)
+    {
+        hits.resize(rays.size());
+        for(std::size_t index = 0; index < rays.size(); ++index)
+            cast_ray(rays[index], mode, mask, hits[index]);
+    }
+
+    void manager::cast_ray(const ray_query& ray, query_mode mode, unsigned long mask, query_hit& hit)
+    {
+        hit.hit_object = 0;
+        hit.object_interface = 0;
+        hit.depth = ray.length;
+
+        //a closest hit ray must find the closest contact on a trimesh too.
+        dGeomRaySetClosestHit(ray_geom, mode == closest_hit);
+        dGeomRaySetLength(ray_geom, ray.length);
+        dGeomRaySet(ray_geom, ray.origin[0], ray.origin[1], ray.origin[2], 
+                ray.direction[0], ray.direction[1], ray.direction[2]);
+        query(ray_geom, mode, mask, &hit, 0);
+    }
+
+    std::size_t manager::overlap_sphere(double x, double y, double z, double radius, 
+            query_hit_list& hits, unsigned long mask)
+    {
+        const std::size_t start = hits.size();
+        dGeomSphereSetRadius(sphere_geom, radius);
+        dGeomSetPosition(sphere_geom, x, y, z);
+        query(sphere_geom, closest_hit, mask, 0, &hits);
+        return hits.size() - start;
+    }
+
+    std::size_t manager::overlap_box(double x, double y, double z, 
+            double size_x, double size_y, double size_z, 
+            query_hit_list& hits, unsigned long mask)
+    {
+        const std::size_t start = hits.size();
+        dGeomBoxSetLengths(box_geom, size_x, size_y, size_z);
+        dGeomSetPosition(box_geom, x, y, z);
+        query(box_geom, closest_hit, mask, 0, &hits);
+        return hits.size() - start;
+    }
+
     void manager::step(double step_size)
     {
         dSpaceCollide (space_id, reinterpret_cast<void*>(this), near_callback);  //do collision detection on the space
+        //static objects are only collided with the rigid bodies.
+        dSpaceCollide2 (reinterpret_cast<dGeomID>(space_id), reinterpret_cast<dGeomID>(static_space_id), reinterpret_cast<void*>(this), near_callback);
         dWorldQuickStep (world_id, step_size);      //step the simulation
         dJointGroupEmpty (contact_group_id);      //empty all the collision contacts
+        deliver_collisions();
     }
     manager::~manager()
     {
+        dGeomDestroy(box_geom);
+        dGeomDestroy(sphere_geom);
+        dGeomDestroy(ray_geom);
+        dSpaceDestroy(static_space_id);
         dSpaceDestroy(space_id);
         dWorldDestroy(world_id);
     }
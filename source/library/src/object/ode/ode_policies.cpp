@@ -78,9 +78,12 @@ namespace ode
         
     }
     
-    object::object() : world_id(0), space_id(0), body_id(0), material()
+    object::object() : world_id(0), space_id(0), body_id(0), material(), collision_geom(0), category_bits(~0ul), collide_bits(~0ul), manager_ptr(0), moved(true)
     {
-    //....currently empty
+        geom_info.owner = this;
+        geom_info.object_interface = 0;
+        geom_info.material = 0;
+        geom_info.solid = true;
     }
     void object::get_orientation(double& x, double& y, double& z, double& w) const
     {
@@ -96,7 +99,9 @@ namespace ode
     }
     void object::set_position(double x, double y, double z)
     {
-        if(body_id) dBodySetPosition (body_id,x, y, z);
+        if(!body_id) return;
+        dBodySetPosition (body_id,x, y, z);
+        moved = true;
     }
     
     void object::set_orientation(double x, double y, double z, double w)
@@ -104,6 +109,7 @@ namespace ode
 		if(!body_id) return;
         dQuaternion quat = { w, x, y, z};
         dBodySetQuaternion(body_id,quat);
+        moved = true;
     }
 	
 	void object::set_velocity(double x, double y, double z)
@@ -124,17 +130,47 @@ namespace ode
         dBodySetAutoDisableDefaults(body_id);
     }
     
-    void object::set_geom_data(dGeomID geom)
+    void object::set_geom_data(dGeomID geom, manager& mgr)
     {
         if(geom)
         {
             //for the materials to work correctly when two objects collide we must
-            //store a pointer to the class itself in the geom. This alows us to cast back
-            //in the collision near callback function used by ode_manager and get the
-            //bouncyness, friction, etc, of the object.
-            dGeomSetData(geom,reinterpret_cast<void*>(this));
+            //store the geom data in the geom. The collision near callback function 
+            //used by ode_manager gets the material and the object from it. The 
+            //object is cast once here instead of on every collision.
+            if(manager_ptr) manager_ptr->release_material(geom_info.material);
+            manager_ptr = &mgr;
+            geom_info.object_interface = dynamic_cast<ncc::object::abstract_interface*>(this);
+            geom_info.material = mgr.get_material(material.friction, material.bounce);
+            dGeomSetData(geom,reinterpret_cast<void*>(&geom_info));
+
+            collision_geom = geom;
+            dGeomSetCategoryBits(geom, category_bits);
+            dGeomSetCollideBits(geom, collide_bits);
         }
     }
+
+    void object::set_collision_category(unsigned long bits)
+    {
+        category_bits = bits;
+        if(collision_geom) dGeomSetCategoryBits(collision_geom, bits);
+    }
+
+    void object::set_collision_mask(unsigned long bits)
+    {
+        collide_bits = bits;
+        if(collision_geom) dGeomSetCollideBits(collision_geom, bits);
+    }
+
+    void object::update_material()
+    {
+        if(!manager_ptr) return;
+        //the new material is taken before the old one is released so that 
+        //an unchanged material is not removed and added again.
+        const material_id previous = geom_info.material;
+        geom_info.material = manager_ptr->get_material(material.friction, material.bounce);
+        manager_ptr->release_material(previous);
+    }
 	
 	void collidable_object::get_orientation(double& x, double& y, double& z, double& w) const
     {
@@ -170,6 +206,7 @@ namespace ode
 		
 		if(!geom_id) return;
         dGeomSetPosition (geom_id,x, y, z);
+        moved = true;
     }
     void collidable_object::set_orientation(double x, double y, double z, double w)
     {
@@ -181,9 +218,41 @@ namespace ode
 		if(!geom_id) return;
         dQuaternion quat = { w, x, y, z};
         dGeomSetQuaternion(geom_id,quat);
+        moved = true;
     }
 
 
+    bool collidable_object::update_dynamics(double mass)
+    {
+        //the object was created by a manager if the geom data was set.
+        if(!geom_id || !manager_ptr) return body_id != 0;
+
+        if(mass > 0 && !body_id)
+        {
+            const dReal* position = dGeomGetPosition(geom_id);
+            dQuaternion quat; dGeomGetQuaternion(geom_id, quat);
+            object::create_rigid_body(position[0], position[1], position[2], *manager_ptr);
+            dBodySetQuaternion(body_id, quat);
+            dGeomSetBody(geom_id, body_id);
+        }
+        else if(mass <= 0 && body_id)
+        {
+            //the geom takes over the position and orientation of the body.
+            dGeomSetBody(geom_id, 0);
+            dBodyDestroy(body_id);
+            body_id = 0;
+            material.mass = 0;
+        }
+        else return body_id != 0;
+
+        dSpaceID target = select_space(mass, *manager_ptr);
+        dSpaceRemove(space_id, geom_id);
+        dSpaceAdd(target, geom_id);
+        space_id = target;
+        moved = true;
+        return body_id != 0;
+    }
+
     void box::create_physical_body(
                     double x, 
                     double y, 
@@ -195,11 +264,11 @@ namespace ode
                     manager& mgr)
     {
          world_id = mgr.ode_world();
-         space_id = mgr.ode_space();
+         space_id = select_space(mass, mgr);
 
         //create and position the geom to represent the pysical shape of the rigid body   
-        geom_id = dCreateBox (mgr.ode_space(), size_x, size_y, size_z);
-        object::set_geom_data(geom_id);
+        geom_id = dCreateBox (space_id, size_x, size_y, size_z);
+        object::set_geom_data(geom_id, mgr);
         dGeomSetPosition (geom_id, x, y, z); 		
 		size[0] = size_x;
         size[1] = size_y;
@@ -215,7 +284,7 @@ namespace ode
 
     void box::set_mass(double mass)
     {
-        if(body_id)
+        if(update_dynamics(mass))
         {
             dMass dmass;
             dMassSetZero(&dmass); 
@@ -236,10 +305,10 @@ namespace ode
 		this->radius = radius;
 
 		world_id = mgr.ode_world();
-		space_id = mgr.ode_space();
+		space_id = select_space(mass, mgr);
         //create and position the geom to represent the physical shape of the rigid body   
-        geom_id = dCreateSphere(mgr.ode_space(),radius);
-        object::set_geom_data(geom_id);
+        geom_id = dCreateSphere(space_id,radius);
+        object::set_geom_data(geom_id, mgr);
         dGeomSetPosition (geom_id, x, y, z); 		
 		
 		if(mass > 0)
@@ -253,7 +322,7 @@ namespace ode
 
     void sphere::set_mass(double mass)
     {
-        if(body_id)
+        if(update_dynamics(mass))
         {
             dMass dmass;
             dMassSetZero(&dmass); 
@@ -276,10 +345,10 @@ namespace ode
 		this->length = length;
 
 		world_id = mgr.ode_world();
-		space_id = mgr.ode_space();
+		space_id = select_space(mass, mgr);
         //create and position the geom to represent the physical shape of the rigid body   
-        geom_id = dCreateCylinder(mgr.ode_space(),radius, length);
-        object::set_geom_data(geom_id);
+        geom_id = dCreateCylinder(space_id,radius, length);
+        object::set_geom_data(geom_id, mgr);
         dGeomSetPosition (geom_id, x, y, z); 		
 		
 		if(mass > 0)
@@ -293,7 +362,7 @@ namespace ode
 
     void cylinder::set_mass(double mass)
     {
-        if(body_id)
+        if(update_dynamics(mass))
         {
             dMass dmass;
             dMassSetZero(&dmass); 
@@ -316,15 +385,15 @@ namespace ode
         this->length = length;      
 	
 		world_id = mgr.ode_world();
-		space_id = mgr.ode_space();
+		space_id = select_space(mass, mgr);
         //set the body orientation
       //  dMatrix3 R;
         //dRFromAxisAndAngle(R,1,0,0,M_PI/2);
         //dBodySetRotation(body_id,R);
 
         //create the geom
-        geom_id=dCreateCapsule(mgr.ode_space(),radius,length);
-        object::set_geom_data(geom_id); //must make sure to set the geom data for the collision callback!
+        geom_id=dCreateCapsule(space_id,radius,length);
+        object::set_geom_data(geom_id, mgr); //must make sure to set the geom data for the collision callback!
 		dGeomSetPosition (geom_id, x, y, z); 		
 
 		if(mass > 0)
@@ -333,31 +402,43 @@ namespace ode
 			set_mass(mass);
 			dGeomSetBody(geom_id,body_id);
 		
-			              
-			//create an amotor to keep the body vertical
-			amotor_id=dJointCreateAMotor(mgr.ode_world(),0);
-			dJointAttach(amotor_id,body_id,0);
-			dJointSetAMotorMode(amotor_id,dAMotorEuler);
-			dJointSetAMotorNumAxes(amotor_id,3); 
-			dJointSetAMotorAxis(amotor_id,0,0,1,0,0); 
-			dJointSetAMotorAxis(amotor_id,1,0,0,1,0);
-			dJointSetAMotorAxis(amotor_id,2,0,0,0,1);
-			dJointSetAMotorAngle(amotor_id,0,0);
-			dJointSetAMotorAngle(amotor_id,1,0);
-			dJointSetAMotorAngle(amotor_id,2,0);
-			dJointSetAMotorParam(amotor_id,dParamLoStop,-0);
-			dJointSetAMotorParam(amotor_id,dParamLoStop3,-0);
-			dJointSetAMotorParam(amotor_id,dParamLoStop2,-0);
-			dJointSetAMotorParam(amotor_id,dParamHiStop,0);
-			dJointSetAMotorParam(amotor_id,dParamHiStop3,0);
-			dJointSetAMotorParam(amotor_id,dParamHiStop2,0);
-		
+			keep_upright();
 		}
     }
+
+    void capsule::keep_upright()
+    {
+        if(amotor_id)
+        {
+            dJointAttach(amotor_id,body_id,0);
+            return;
+        }
+
+        //create an amotor to keep the body vertical
+        amotor_id=dJointCreateAMotor(world_id,0);
+        dJointAttach(amotor_id,body_id,0);
+        dJointSetAMotorMode(amotor_id,dAMotorEuler);
+        dJointSetAMotorNumAxes(amotor_id,3); 
+        dJointSetAMotorAxis(amotor_id,0,0,1,0,0); 
+        dJointSetAMotorAxis(amotor_id,1,0,0,1,0);
+        dJointSetAMotorAxis(amotor_id,2,0,0,0,1);
+        dJointSetAMotorAngle(amotor_id,0,0);
+        dJointSetAMotorAngle(amotor_id,1,0);
+        dJointSetAMotorAngle(amotor_id,2,0);
+        dJointSetAMotorParam(amotor_id,dParamLoStop,-0);
+        dJointSetAMotorParam(amotor_id,dParamLoStop3,-0);
+        dJointSetAMotorParam(amotor_id,dParamLoStop2,-0);
+        dJointSetAMotorParam(amotor_id,dParamHiStop,0);
+        dJointSetAMotorParam(amotor_id,dParamHiStop3,0);
+        dJointSetAMotorParam(amotor_id,dParamHiStop2,0);
+    }
+
     void capsule::set_mass(double mass)
     {
-      if(body_id)
+        const bool had_body = body_id != 0;
+        if(update_dynamics(mass))
         {
+            if(!had_body) keep_upright();
             dMass dmass;
             dMassSetZero(&dmass); 
             dMassSetSphereTotal(&dmass,mass,radius);
@@ -381,7 +462,7 @@ namespace ode
                    manager& mgr)
     {
         world_id = mgr.ode_world();
-        space_id = mgr.ode_space();
+        space_id = select_space(mass, mgr);
 
         //see if the trimesh data is cached so that we don't have to recreate it
         if(name.size() > 0) mesh_data = mgr.trimesh_cache().get_data(name);
@@ -400,19 +481,20 @@ namespace ode
         }
 
         //create the geom using the trimesh data
-        geom_id = dCreateTriMesh(mgr.ode_space(),mesh_data->data_id, 0, 0, 0); 
+        geom_id = dCreateTriMesh(space_id,mesh_data->data_id, 0, 0, 0); 
 
-        object::set_geom_data(geom_id);
+        object::set_geom_data(geom_id, mgr);
         //create and position the geom to represent the pysical shape of the rigid body   
         dGeomSetPosition (geom_id, x, y, z); //we position it at the center relative to the body
+        //the size is kept even for a static mesh in case it is given a mass later.
+        size[0] = size_x;
+        size[1] = size_y;
+        size[2] = size_z;
         //if the mass is greater than 0 then the object is a dynamic mesh
         //so we have to create a rigid body
         if(mass > 0)
         {
             create_rigid_body(x, y, z,  mgr);
-            size[0] = size_x;
-            size[1] = size_y;
-            size[2] = size_z;
             set_mass(mass);
             dGeomSetBody (geom_id, body_id); 
         }
@@ -420,7 +502,7 @@ namespace ode
 
     void trimesh::set_mass(double mass)
     {
-        if(body_id)
+        if(update_dynamics(mass))
         {   
             dMass dmass;
             dMassSetBoxTotal (&dmass, mass, size[0], size[1], size[2]);
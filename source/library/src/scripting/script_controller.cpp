@@ -30,6 +30,7 @@
  */
 
 #include "scripting/script_controller.h"
+#include "controller/typed_message.h"
 #include <sstream>
 using namespace luabind;
 namespace ncc {
@@ -78,18 +79,19 @@ namespace lua
                                 controller_mgr(controller_manager),
 								property_mgr(property_manager),
                                 file_name(file),
-                                bind_function(bind_func)
+                                bind_function(bind_func),
+                                initialized(false),
+                                batch_messages(false)
     {
         bind_func(lua_script.state());		
     }
     bool controller::initialize(const parameter_list& param)
     {
 		if(!is_alive()) return false;
-		set_pcall_callback(print_file_and_line);
-		luabind::globals(lua_script.state())["game"] = this;
-        if(lua_script.load(file_name) == false) return false;
+        if(!prepare()) return false;
         try
         {
+            initialized = true;
 			return call_function<bool>(lua_script.state(),"initialize", param);
         }
         catch(luabind::error& e)
@@ -115,9 +117,30 @@ namespace lua
     void controller::handle_message(const parameter& message, const parameter_list& params, controller::abstract_interface& from)
     {
 		if(!is_alive()) return;
+        if(batch_messages)
+        {
+            queued_message queued;
+            queued.message = &message;
+            queued.params = &params;
+            queued.from = from.get_handle();
+            queued_messages.push_back(queued);
+
+            queued_message& back = queued_messages.back();
+            std::string name;
+            if(ncc::controller::message::to_script(message, name, back.script_params))
+                back.script_message = name;
+            return;
+        }
         try
         {
-			call_function<void>(lua_script.state(), "handle_message", message, params, &from);
+            //typed messages registered for scripts are seen by the script 
+            //as their name and parameters.
+            std::string name;
+            parameter_list script_params;
+            if(ncc::controller::message::to_script(message, name, script_params))
+                call_function<void>(lua_script.state(), "handle_message", parameter(name), script_params, from.get_handle());
+            else
+                call_function<void>(lua_script.state(), "handle_message", message, params, from.get_handle());
         }
         catch(luabind::error& e)
         {
@@ -125,6 +148,41 @@ namespace lua
         }        
     }
 	
+    void controller::messages_delivered()
+    {
+        if(queued_messages.empty()) return;
+        if(!is_alive()) 
+        {
+            queued_messages.clear();
+            return;
+        }
+
+        try
+        {
+            lua_State* state = lua_script.state();
+            luabind::object batch = luabind::newtable(state);
+            for(std::size_t index = 0; index < queued_messages.size(); ++index)
+            {
+                queued_message& queued = queued_messages[index];
+                const bool converted = !queued.script_message.empty();
+
+                //the script gets copies since the messages are erased after
+                //the step and a script may keep what it was sent.
+                luabind::object entry = luabind::newtable(state);
+                entry["message"] = converted ? queued.script_message : *queued.message;
+                entry["params"] = converted ? queued.script_params : *queued.params;
+                entry["from"] = queued.from;
+                batch[static_cast<int>(index) + 1] = entry;
+            }
+            call_function<void>(state, "handle_messages", batch);
+        }
+        catch(luabind::error& e)
+        {
+            std::cout << "Lua Error: " << e.what() << std::endl;
+        }
+        queued_messages.clear();
+    }
+
     controller::abstract_interface* controller::clone_prototype() 
     { 
         controller::abstract_interface* cntr = 0;
@@ -140,8 +198,20 @@ namespace lua
             return 0;
         }
     }
-    controller::~controller() 
-    {	
+    bool controller::prepare()
+    {
+		set_pcall_callback(print_file_and_line);
+		luabind::globals(lua_script.state())["game"] = this;
+        //a recycled script is already loaded.
+        if(!lua_script.ready() && !lua_script.load(file_name)) return false;
+        batch_messages = luabind::type(luabind::globals(lua_script.state())["handle_messages"]) == LUA_TFUNCTION;
+        return true;
+    }
+
+    void controller::destroy()
+    {
+        if(!initialized) return;
+        initialized = false;
 		try
         {
             call_function<void>(lua_script.state(), "destroy");
@@ -150,7 +220,19 @@ namespace lua
         {
             std::cout << "Lua Error: " << e.what() << std::endl;
         }
-		
+    }
+
+    bool controller::recycle()
+    {
+        destroy();
+        callbacks.clear();
+        queued_messages.clear();
+        return prepare();
+    }
+
+    controller::~controller() 
+    {	
+        destroy();
     }
 	void controller::remove()
 	{	 
@@ -160,6 +242,8 @@ namespace lua
 	bool controller::collision_callback(ode::collision_info info)
 	{
 		//if(!info.object_ptr) return true;
+		//a collision wakes a sleeping controller.
+		wake();
 		callback_map::iterator found_callback = callbacks.find(info.object_1);
 		
 		//If there is no callback we assume the object will want to collide
@@ -167,10 +251,10 @@ namespace lua
 		try
 		{
 			//call the apropriate lua function for that object and send it a pointer to the 
-			//object for which it collided with
+			//object for which it collided with and the collision info.
 			object::abstract_interface* object = info.object_2;
 			
-			return object ? call_function<bool>(lua_script.state(), found_callback->second.c_str(), object) : true;
+			return object ? call_function<bool>(lua_script.state(), found_callback->second.c_str(), object, info) : true;
 		}
 		catch(luabind::error& e)
         {
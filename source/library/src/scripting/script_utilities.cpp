@@ -30,6 +30,7 @@
  */
 
 #include "scripting/script_utilities.h"
+#include "controller/typed_message.h"
 #include <luabind/operator.hpp>
 #include <luabind/adopt_policy.hpp>
 #include <luabind/dependency_policy.hpp>
@@ -160,29 +161,40 @@ namespace utilities
 																	script->property_manager()));
 		script->controller_manager().add_prototype(name, new_script);
 	}               
-	ncc::controller::abstract_interface* add_controller(ncc::lua::controller* script, 
+	void set_script_pool(ncc::lua::controller* script, const std::string& name, int size, int warm_up)
+	{
+		if(!script || size < 0 || warm_up < 0) return;
+		script->controller_manager().set_prototype_pool(name, size, warm_up);
+	}
+	//scripts are given handles to controllers instead of pointers so 
+	//that a controller which is gone cannot be reached. get_controller
+	//turns a handle back into the controller for scripts which call its
+	//methods. The controller it returns is only valid during the call of 
+	//the script which got it, so scripts keep the handle and call 
+	//get_controller each time.
+	handle add_controller(ncc::lua::controller* script, 
 											const std::string& name, 
 											const parameter_list& params)
 	{
-		if(!script) return 0;
+		if(!script) return handle();
 		ncc::controller::weak_ptr new_controller = script->controller_manager().add_controller(name, params);
 		if(ncc::controller::ptr pointer = new_controller.lock()) 
-			return pointer.get();
+			return pointer->get_handle();
 		else 
-			return 0;		
+			return handle();		
 	}
         
         
-	ncc::controller::abstract_interface* add_controller_as_child(ncc::lua::controller* script, 
+	handle add_controller_as_child(ncc::lua::controller* script, 
 											const std::string& name, 
 											const parameter_list& params)
 	{
-		if(!script) return 0;
+		if(!script) return handle();
 		ncc::controller::weak_ptr new_controller = script->controller_manager().add_controller(name, params, script->self());
 		if(ncc::controller::ptr pointer = new_controller.lock()) 
-			return pointer.get();
+			return pointer->get_handle();
 		else 
-			return 0;		
+			return handle();		
 	}
                              
     void remove_controller(ncc::lua::controller* script, const std::string& name)
@@ -191,30 +203,42 @@ namespace utilities
 		script->controller_manager().remove_controller(name);
 	}
                
-	void remove_controller(ncc::lua::controller* script, ncc::controller::abstract_interface* controller)
+	void remove_controller(ncc::lua::controller* script, const handle& target)
 	{
-		if(!script || !controller) return;
+		if(!script) return;
+		ncc::controller::abstract_interface* controller = script->controller_manager().get_controller(target);
+		if(!controller) return;
 		ncc::controller::ptr controller_ptr = controller->self();
 		script->controller_manager().remove_controller(controller_ptr);
 	}
        
-	ncc::controller::abstract_interface* find_controller(ncc::lua::controller* script, const std::string& name)
+	handle find_controller(ncc::lua::controller* script, const std::string& name)
 	{
-		if(!script) return 0;
+		if(!script) return handle();
 		ncc::controller::weak_ptr found_controller = script->controller_manager().find_controller(name);
 		if(ncc::controller::ptr pointer = found_controller.lock()) 
-			return pointer.get();
+			return pointer->get_handle();
 		else 
-			return 0;		
-	}            
+			return handle();		
+	}
+
+	ncc::controller::abstract_interface* get_controller(ncc::lua::controller* script, const handle& target)
+	{
+		if(!script) return 0;
+		return script->controller_manager().get_controller(target);
+	}
+
+	bool is_valid(ncc::lua::controller* script, const handle& target)
+	{
+		return get_controller(script, target) != 0;
+	}
         
     //1    
     void send_message(ncc::lua::controller* script,					
 						const std::string& name,
 						const parameter& message)
 	{
-		if(!script) return;
-		script->controller_manager().send_message(script, name, message);
+		send_message(script, name, message, parameter_list());
 	}  
 
 	//2
@@ -224,28 +248,35 @@ namespace utilities
 						const parameter_list& params)
 	{
 		if(!script) return;
-		script->controller_manager().send_message(script, name, message, params);
+		parameter typed;
+		if(ncc::controller::message::from_script(message, params, typed))
+			script->controller_manager().send_message(script, name, typed);
+		else
+			script->controller_manager().send_message(script, name, message, params);
 	}
     
 	//3
     void send_message(ncc::lua::controller* script,
-						ncc::controller::abstract_interface* recipient,
+						const handle& recipient,
                         const parameter& message)
 	{
-		if(!script || !recipient) return;
-		ncc::controller::ptr controller_ptr = recipient->self();
-		script->controller_manager().send_message(script, controller_ptr, message);
+		send_message(script, recipient, message, parameter_list());
 	}
     
 	//4
     void send_message(ncc::lua::controller* script,
-						ncc::controller::abstract_interface* recipient,
+						const handle& recipient_handle,
                         const parameter& message,
 						const parameter_list& params)
 	{
-		if(!script || !recipient) return;
+		ncc::controller::abstract_interface* recipient = get_controller(script, recipient_handle);
+		if(!recipient) return;
 		ncc::controller::ptr controller_ptr = recipient->self();
-		script->controller_manager().send_message(script, controller_ptr, message, params);
+		parameter typed;
+		if(ncc::controller::message::from_script(message, params, typed))
+			script->controller_manager().send_message(script, controller_ptr, typed);
+		else
+			script->controller_manager().send_message(script, controller_ptr, message, params);
 	}
         
     //5
@@ -253,8 +284,7 @@ namespace utilities
                              const std::string& type, 
                              const parameter& message)
 	{
-		if(!script) return;
-		script->controller_manager().send_message_to_all(script, type, message);
+		send_message_to_all(script, type, message, parameter_list());
 	}
     
     //6
@@ -264,15 +294,18 @@ namespace utilities
 							 const parameter_list& params)
 	{
 		if(!script) return;
-		script->controller_manager().send_message_to_all(script, type, message, params);
+		parameter typed;
+		if(ncc::controller::message::from_script(message, params, typed))
+			script->controller_manager().send_message_to_all(script, type, typed);
+		else
+			script->controller_manager().send_message_to_all(script, type, message, params);
 	}
         
     //7
     void send_message_to_all(ncc::lua::controller* script,                         
                              const parameter& message)
 	{
-		if(!script) return;
-		script->controller_manager().send_message_to_all(script, message);
+		send_message_to_all(script, message, parameter_list());
 	}
     
     //8
@@ -281,9 +314,83 @@ namespace utilities
 							 const parameter_list& params)
 	{
 		if(!script) return;
-		script->controller_manager().send_message_to_all(script, message, params);
+		parameter typed;
+		if(ncc::controller::message::from_script(message, params, typed))
+			script->controller_manager().send_message_to_all(script, typed);
+		else
+			script->controller_manager().send_message_to_all(script, message, params);
 	}
 
+	void enable_message_stats(ncc::lua::controller* script, bool enable)
+	{
+		if(!script) return;
+		script->controller_manager().enable_message_statistics(enable);
+	}
+	void clear_message_stats(ncc::lua::controller* script)
+	{
+		if(!script) return;
+		script->controller_manager().clear_message_statistics();
+	}
+	bool dump_message_stats(ncc::lua::controller* script, const std::string& file_name)
+	{
+		if(!script) return false;
+		return script->controller_manager().get_message_statistics().dump(file_name);
+	}
+	object frame_table(lua_State* state, const ncc::controller::message::statistics::frame& counters, double frames)
+	{
+		if(frames <= 0) frames = 1;
+		object table = newtable(state);
+		table["added"] = counters.added / frames;
+		table["posted"] = counters.posted / frames;
+		table["pending"] = counters.pending / frames;
+		table["scheduled"] = counters.scheduled / frames;
+		table["checked"] = counters.checked / frames;
+		table["sent"] = counters.sent / frames;
+		table["dropped"] = counters.dropped / frames;
+		table["deliveries"] = counters.deliveries / frames;
+		table["recipients"] = counters.recipients / frames;
+		table["visited"] = counters.visited / frames;
+		table["seconds"] = counters.seconds / frames;
+		return table;
+	}
+	object histogram_table(lua_State* state, const ncc::controller::message::latency_histogram& histogram)
+	{
+		object table = newtable(state);
+		table["count"] = histogram.count();
+		table["mean"] = histogram.mean();
+		table["p50"] = histogram.percentile(0.5);
+		table["p90"] = histogram.percentile(0.9);
+		table["p99"] = histogram.percentile(0.99);
+		table["max"] = histogram.max();
+		return table;
+	}
+	///returns a table with the last and average frame, the latencies, and 
+	///the ten messages sent the most.
+	object message_stats(ncc::lua::controller* script)
+	{
+		if(!script) return object();
+		lua_State* state = script->lua_state();
+		const ncc::controller::message::statistics& stats = script->controller_manager().get_message_statistics();
+
+		object table = newtable(state);
+		table["frames"] = stats.frames;
+		table["last"] = frame_table(state, stats.last, 1);
+		table["average"] = frame_table(state, stats.total, stats.frames);
+		table["latency"] = histogram_table(state, stats.delivery_latency);
+		table["condition_wait"] = histogram_table(state, stats.condition_wait);
+
+		object top = newtable(state);
+		ncc::controller::message::statistics::name_count_list counts = stats.top_messages(10);
+		for(std::size_t index = 0; index < counts.size(); ++index)
+		{
+			object entry = newtable(state);
+			entry["name"] = counts[index].first;
+			entry["count"] = counts[index].second;
+			top[static_cast<int>(index) + 1] = entry;
+		}
+		table["top"] = top;
+		return table;
+	}
 	
 	void set_gravity(ncc::lua::controller* script, double x, double y, double z)
 	{
@@ -333,6 +440,32 @@ namespace utilities
 	}
 
 	
+	vector_3dd get_collision_position(const ode::collision_info* info)
+	{
+		return info ? vector_3dd(info->position[0], info->position[1], info->position[2]) : vector_3dd();
+	}
+
+	vector_3dd get_collision_normal(const ode::collision_info* info)
+	{
+		return info ? vector_3dd(info->normal[0], info->normal[1], info->normal[2]) : vector_3dd();
+	}
+
+	scope bind_collision_info()
+	{
+		return class_<ode::collision_info>("collision_info")
+			.enum_("state")
+			[
+				value("contact_begin", ode::collision_info::contact_begin),
+				value("contact_persist", ode::collision_info::contact_persist),
+				value("contact_end", ode::collision_info::contact_end)
+			]
+			.def_readonly("depth", &ode::collision_info::depth)
+			.def_readonly("state", &ode::collision_info::state)
+			.def_readonly("relative_speed", &ode::collision_info::relative_speed)
+			.def("get_position", &get_collision_position)
+			.def("get_normal", &get_collision_normal);
+	}
+
 	collision_result ray_cast(ncc::lua::controller* script, 
 					vector_3dd start,
 					vector_3dd direction,
@@ -352,6 +485,96 @@ namespace utilities
 		return c_result;
 	}
          
+	///writes a query hit to the table at index of results, reusing the 
+	///table already there.
+	void fill_query_result(lua_State* state, object& results, int index, const ode::query_hit& hit)
+	{
+		object entry = results[index];
+		if(type(entry) != LUA_TTABLE)
+		{
+			entry = newtable(state);
+			results[index] = entry;
+		}
+		entry["hit"] = hit.hit_object != 0;
+		entry["depth"] = hit.hit_object ? hit.depth : -1;
+		entry["object"] = hit.object_interface;
+		entry["position"] = vector_3dd(hit.position[0], hit.position[1], hit.position[2]);
+		entry["normal"] = vector_3dd(hit.normal[0], hit.normal[1], hit.normal[2]);
+	}
+
+	///casts every ray of rays, a table of tables with start, direction, and 
+	///length, and fills results with a table for each ray. Returns the 
+	///number of rays which hit an object.
+	int cast_rays(ncc::lua::controller* script, object rays, object results, bool any_hit, unsigned long mask)
+	{
+		if(!script || type(rays) != LUA_TTABLE || type(results) != LUA_TTABLE) return 0;
+
+		ode::ray_query_list queries;
+		for(int index = 1; type(rays[index]) == LUA_TTABLE; ++index)
+		{
+			object ray = rays[index];
+			const vector_3dd start = object_cast<vector_3dd>(ray["start"]);
+			const vector_3dd direction = object_cast<vector_3dd>(ray["direction"]);
+			const ode::ray_query query = { {start.x(), start.y(), start.z()}, 
+				{direction.x(), direction.y(), direction.z()}, 
+				object_cast<double>(ray["length"])};
+			queries.push_back(query);
+		}
+
+		ode::query_hit_list hits;
+		script->ode_manager().ray_cast(queries, hits, any_hit ? ode::manager::any_hit : ode::manager::closest_hit, mask);
+
+		int hit_count = 0;
+		for(std::size_t index = 0; index < hits.size(); ++index)
+		{
+			fill_query_result(script->lua_state(), results, static_cast<int>(index) + 1, hits[index]);
+			if(hits[index].hit_object) ++hit_count;
+		}
+		return hit_count;
+	}
+
+	int cast_rays(ncc::lua::controller* script, object rays, object results)
+	{
+		return cast_rays(script, rays, results, false, ~0ul);
+	}
+
+	///fills results with the hits of an overlap query and clears the 
+	///entries left from an earlier query.
+	int fill_overlap_results(ncc::lua::controller* script, object& results, const ode::query_hit_list& hits)
+	{
+		for(std::size_t index = 0; index < hits.size(); ++index)
+			fill_query_result(script->lua_state(), results, static_cast<int>(index) + 1, hits[index]);
+		for(int index = static_cast<int>(hits.size()) + 1; type(results[index]) != LUA_TNIL; ++index)
+			results[index] = object();
+		return static_cast<int>(hits.size());
+	}
+
+	int overlap_sphere(ncc::lua::controller* script, vector_3dd center, double radius, object results, unsigned long mask)
+	{
+		if(!script || type(results) != LUA_TTABLE) return 0;
+		ode::query_hit_list hits;
+		script->ode_manager().overlap_sphere(center.x(), center.y(), center.z(), radius, hits, mask);
+		return fill_overlap_results(script, results, hits);
+	}
+
+	int overlap_sphere(ncc::lua::controller* script, vector_3dd center, double radius, object results)
+	{
+		return overlap_sphere(script, center, radius, results, ~0ul);
+	}
+
+	int overlap_box(ncc::lua::controller* script, vector_3dd center, vector_3dd size, object results, unsigned long mask)
+	{
+		if(!script || type(results) != LUA_TTABLE) return 0;
+		ode::query_hit_list hits;
+		script->ode_manager().overlap_box(center.x(), center.y(), center.z(), size.x(), size.y(), size.z(), hits, mask);
+		return fill_overlap_results(script, results, hits);
+	}
+
+	int overlap_box(ncc::lua::controller* script, vector_3dd center, vector_3dd size, object results)
+	{
+		return overlap_box(script, center, size, results, ~0ul);
+	}
+         
 	osg_ode::box* create_box(ncc::lua::controller* script, 
 								vector_3dd pos, 
                                 vector_3dd size,
@@ -479,22 +702,35 @@ namespace utilities
 			.def("set_mouse_position", &set_mouse_position)
 			.def("button_pressed", &button_pressed)
 			.def("register_script", &register_script)
+			.def("set_script_pool", &set_script_pool)
 			.def("add_controller", &add_controller)
 			.def("add_controller_as_child", &add_controller_as_child)
 			.def("remove_controller", (void(*)(ncc::lua::controller*, const std::string&))&remove_controller)
-			.def("remove_controller", (void(*)(ncc::lua::controller*, ncc::controller::abstract_interface*))&remove_controller)
+			.def("remove_controller", (void(*)(ncc::lua::controller*, const handle&))&remove_controller)
 			.def("find_controller", &find_controller)
+			.def("get_controller", &get_controller)
+			.def("is_valid", &is_valid)
 			.def("set_collision_callback", &ncc::lua::controller::set_collision_callback)
 			.def("send_message", (void(*)(ncc::lua::controller*,const std::string&,const parameter&))&send_message)
 			.def("send_message", (void(*)(ncc::lua::controller*,const std::string&,const parameter&, const parameter_list&))&send_message)
-			.def("send_message_to", (void(*)(ncc::lua::controller*,ncc::controller::abstract_interface*,const parameter&))&send_message)
-			.def("send_message_to", (void(*)(ncc::lua::controller*,ncc::controller::abstract_interface*,const parameter&, const parameter_list&))&send_message)
+			.def("send_message_to", (void(*)(ncc::lua::controller*,const handle&,const parameter&))&send_message)
+			.def("send_message_to", (void(*)(ncc::lua::controller*,const handle&,const parameter&, const parameter_list&))&send_message)
 			.def("send_message_to_all", (void(*)(ncc::lua::controller*,const std::string&,const parameter&))&send_message_to_all)
 			.def("send_message_to_all", (void(*)(ncc::lua::controller*,const std::string&,const parameter&, const parameter_list&))&send_message_to_all)
 			.def("send_message_to_all", (void(*)(ncc::lua::controller*,const parameter&))&send_message_to_all)
 			.def("send_message_to_all", (void(*)(ncc::lua::controller*,const parameter&, const parameter_list&))&send_message_to_all)
+			.def("enable_message_stats", &enable_message_stats)
+			.def("clear_message_stats", &clear_message_stats)
+			.def("dump_message_stats", &dump_message_stats)
+			.def("message_stats", &message_stats)
 			.def("set_gravity", &set_gravity)
 			.def("ray_cast", &ray_cast)
+			.def("cast_rays", (int(*)(ncc::lua::controller*, object, object))&cast_rays)
+			.def("cast_rays", (int(*)(ncc::lua::controller*, object, object, bool, unsigned long))&cast_rays)
+			.def("overlap_sphere", (int(*)(ncc::lua::controller*, vector_3dd, double, object))&overlap_sphere)
+			.def("overlap_sphere", (int(*)(ncc::lua::controller*, vector_3dd, double, object, unsigned long))&overlap_sphere)
+			.def("overlap_box", (int(*)(ncc::lua::controller*, vector_3dd, vector_3dd, object))&overlap_box)
+			.def("overlap_box", (int(*)(ncc::lua::controller*, vector_3dd, vector_3dd, object, unsigned long))&overlap_box)
 			.def("get_camera_position", &get_camera_position)
 			.def("get_camera_orientation", &get_camera_orientation)
 			.def("look_at", &camera_look_at)
@@ -530,7 +766,24 @@ namespace utilities
             .def("get_name", &ncc::controller::abstract_interface::get_name)
             .def("set_name", &ncc::controller::abstract_interface::set_name, dependency(result, _1))
             .def("control", &ncc::controller::abstract_interface::control)
+            .def("set_update_interval", &ncc::controller::abstract_interface::set_update_interval)
+            .def("get_update_interval", &ncc::controller::abstract_interface::get_update_interval)
+            .def("set_low_priority", &ncc::controller::abstract_interface::set_low_priority)
+            .def("is_low_priority", &ncc::controller::abstract_interface::is_low_priority)
+            .def("sleep", (void(ncc::controller::abstract_interface::*)())&ncc::controller::abstract_interface::sleep)
+            .def("sleep", (void(ncc::controller::abstract_interface::*)(double))&ncc::controller::abstract_interface::sleep)
+            .def("wake", &ncc::controller::abstract_interface::wake)
+            .def("is_sleeping", &ncc::controller::abstract_interface::is_sleeping)
+            .def("get_handle", &ncc::controller::abstract_interface::get_handle)
             .def("is_alive",&ncc::controller::abstract_interface::is_alive);
+    }
+
+    scope bind_handle()
+    {
+		return class_<handle>("handle")
+				.def(constructor<>())
+				.def("is_null", &handle::is_null)
+				.def(const_self == const_self);
     }       	
     scope bind_osg_ode_mesh()
     {
@@ -566,18 +819,34 @@ namespace utilities
 	}
    	      
 	template <class type>
-	bool parameter_is_type(parameter_list* params, int index)
+	bool parameter_is_type(const parameter_list* params, int index)
 	{		
 		return params ? is_type<type>(params->at(index)) : false;
 	}
 
 	template <class type>
-	type get_parameter(parameter_list* params, int index)
+	type get_parameter(const parameter_list* params, int index)
 	{			
 		return params ? ncc::get<type>(params->at(index)) : type();
 	}
 
-	int get_parameter_size(parameter_list* params)
+	//a controller in a parameter is given to scripts as its handle.
+	handle get_handle_parameter(const parameter& param)
+	{
+		if(ncc::is_type<ncc::controller::abstract_interface*>(param))
+		{
+			ncc::controller::abstract_interface* controller = ncc::get<ncc::controller::abstract_interface*>(param);
+			return controller ? controller->get_handle() : handle();
+		}
+		return ncc::get<handle>(param);
+	}
+
+	handle get_handle_parameter(const parameter_list* params, int index)
+	{
+		return params ? get_handle_parameter(params->at(index)) : handle();
+	}
+
+	int get_parameter_size(const parameter_list* params)
 	{
 		return params ? params->size() : 0;
 	}		  
@@ -585,28 +854,34 @@ namespace utilities
 	scope bind_parameter_list()
 	{
 		 return class_<parameter_list >("parameter_list")				
-				.def("get_int", (int(*)(parameter_list*, int))&get_parameter<int>)
-				.def("get_double", (double(*)(parameter_list*, int))&get_parameter<double>)
-				.def("get_string", (std::string(*)(parameter_list*, int))&get_parameter<std::string>)
-				.def("get_vector", (vector_3dd(*)(parameter_list*, int))&get_parameter<vector_3dd>)
-				.def("get_object", (ncc::object::abstract_interface*(*)(parameter_list*, int))&get_parameter<ncc::object::abstract_interface*>)
-				.def("get_controller",(ncc::controller::abstract_interface*(*)(parameter_list*, int))&get_parameter<ncc::controller::abstract_interface*>)
+				.def("get_int", (int(*)(const parameter_list*, int))&get_parameter<int>)
+				.def("get_double", (double(*)(const parameter_list*, int))&get_parameter<double>)
+				.def("get_string", (std::string(*)(const parameter_list*, int))&get_parameter<std::string>)
+				.def("get_vector", (vector_3dd(*)(const parameter_list*, int))&get_parameter<vector_3dd>)
+				.def("get_object", (ncc::object::abstract_interface*(*)(const parameter_list*, int))&get_parameter<ncc::object::abstract_interface*>)
+				.def("get_handle", (handle(*)(const parameter_list*, int))&get_handle_parameter)
 				.def("size", &get_parameter_size)
 				.def("is_int", &parameter_is_type<int>)
 				.def("is_double", &parameter_is_type<double>)
 				.def("is_string", &parameter_is_type<const char*>)
 				.def("is_vector", &parameter_is_type<vector_3dd>)
 				.def("is_object", &parameter_is_type<ncc::object::abstract_interface*>)
-				.def("is_controller", &parameter_is_type<ncc::controller::abstract_interface*>);
+				.def("is_controller", &parameter_is_type<ncc::controller::abstract_interface*>)
+				.def("is_handle", &parameter_is_type<handle>);
 	}
 
 	template <class type>
-	type get_single_parameter(parameter* param)
+	type get_single_parameter(const parameter* param)
 	{
 		return param ? ncc::get<type>(*param): type();
 	}
+	handle get_single_handle_parameter(const parameter* param)
+	{
+		return param ? get_handle_parameter(*param) : handle();
+	}
+
 	template <class type>
-	bool single_parameter_is_type(parameter* param)
+	bool single_parameter_is_type(const parameter* param)
 	{
 		return param ? ncc::is_type<type>(*param) : false;
 	}
@@ -620,19 +895,21 @@ namespace utilities
 				.def(constructor<const vector_3dd&>())
 				.def(constructor<const ncc::object::abstract_interface*>())
 				.def(constructor<const ncc::controller::abstract_interface*>())
+				.def(constructor<const handle&>())
 				.def(constructor<const parameter&>())
 				.def("get_int", &get_single_parameter<int>)
 				.def("get_double", &get_single_parameter<double>)
 				.def("get_string", &get_single_parameter<std::string>)
 				.def("get_vector", &get_single_parameter<vector_3dd>)
 				.def("get_object", &get_single_parameter<ncc::object::abstract_interface*>)
-				.def("get_controller", &get_single_parameter<ncc::controller::abstract_interface*>)
+				.def("get_handle", &get_single_handle_parameter)
 				.def("is_int", &single_parameter_is_type<int>)
 				.def("is_double", &single_parameter_is_type<double>)
 				.def("is_string", &single_parameter_is_type<std::string>)
 				.def("is_vector", &single_parameter_is_type<vector_3dd>)
 				.def("is_object", &single_parameter_is_type<ncc::object::abstract_interface*>)
-				.def("is_controller", &single_parameter_is_type<ncc::controller::abstract_interface*>);
+				.def("is_controller", &single_parameter_is_type<ncc::controller::abstract_interface*>)
+				.def("is_handle", &single_parameter_is_type<handle>);
 	}
 
 	char myrand()
@@ -652,6 +929,7 @@ namespace utilities
         [			
             bind_vector_3dd(),
 			bind_quaterniond(),
+			bind_handle(),
 			def("slerp", quaterniond::slerp),
 			def("lerp", quaterniond::lerp),
 			def("rotate_to", quaterniond::rotate_to),
@@ -665,7 +943,12 @@ namespace utilities
             ],			
             namespace_("osg_ode")
             [
-				class_<ode::object>("ode_object"),
+				class_<ode::object>("ode_object")
+					.def("set_collision_layer", (void(ode::object::*)(unsigned int))&ode::object::set_collision_layer)
+					.def("set_collision_layer", (void(ode::object::*)(unsigned int, unsigned long))&ode::object::set_collision_layer)
+					.property("collision_category", &ode::object::get_collision_category, &ode::object::set_collision_category)
+					.property("collision_mask", &ode::object::get_collision_mask, &ode::object::set_collision_mask)
+					.property("solid", &ode::object::is_solid, &ode::object::set_solid),
 				class_<osg::object>("osg_object"),
                 bind_osg_ode_mesh(),
                 bind_osg_ode_sphere(),
@@ -680,6 +963,7 @@ namespace utilities
 			bind_parameter(),
 			bind_parameter_list(),
 			bind_collision_result(),
+			bind_collision_info(),
             def("parameters", (parameter_list(*)(const parameter&))&parameters<parameter>),
             def("parameters", (parameter_list(*)(const parameter&, const parameter&))&parameters<parameter, parameter>),
             def("parameters", (parameter_list(*)(const parameter&, const parameter&, const parameter&))&parameters<parameter, parameter, parameter>),
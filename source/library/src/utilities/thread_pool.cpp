@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+#include "utilities/thread_pool.h"
+#include <boost/bind.hpp>
+namespace ncc
+{
+    thread_pool::thread_pool(unsigned int thread_count) : 
+        batch(0), 
+        remaining(0), 
+        stopping(false)
+    {
+        if(thread_count == 0) thread_count = boost::thread::hardware_concurrency();
+        if(thread_count == 0) thread_count = 1;
+
+        for(unsigned int index = 0; index < thread_count; ++index)
+            queues.push_back(queue_ptr(new task_queue()));
+
+        //queue 0 belongs to the thread calling run.
+        for(unsigned int index = 1; index < thread_count; ++index)
+            threads.create_thread(boost::bind(&thread_pool::work, this, index));
+    }
+
+    thread_pool::~thread_pool()
+    {
+        {
+            boost::mutex::scoped_lock lock(state_lock);
+            stopping = true;
+        }
+        work_ready.notify_all();
+        threads.join_all();
+    }
+
+    void thread_pool::run(task_list& tasks)
+    {
+        if(tasks.empty()) return;
+
+        //with a single thread there is nothing to share.
+        if(queues.size() == 1)
+        {
+            for(task_list::iterator current = tasks.begin(); current != tasks.end(); ++current)
+                (*current)();
+            return;
+        }
+
+        //remaining is set before any task is queued because a thread still 
+        //stealing from the last batch can pick up a task as soon as it is 
+        //queued.
+        {
+            boost::mutex::scoped_lock lock(state_lock);
+            remaining = tasks.size();
+        }
+        for(std::size_t index = 0; index < tasks.size(); ++index)
+        {
+            task_queue& queue = *queues[index % queues.size()];
+            boost::mutex::scoped_lock lock(queue.lock);
+            queue.tasks.push_back(&tasks[index]);
+        }
+        {
+            boost::mutex::scoped_lock lock(state_lock);
+            ++batch;
+        }
+        work_ready.notify_all();
+
+        while(run_task(0));
+
+        boost::mutex::scoped_lock lock(state_lock);
+        while(remaining > 0) work_done.wait(lock);
+    }
+
+    void thread_pool::work(unsigned int index)
+    {
+        unsigned long seen_batch = 0;
+        for(;;)
+        {
+            {
+                boost::mutex::scoped_lock lock(state_lock);
+                while(!stopping && batch == seen_batch) work_ready.wait(lock);
+                if(stopping) return;
+                seen_batch = batch;
+            }
+            while(run_task(index));
+        }
+    }
+
+    bool thread_pool::run_task(unsigned int index)
+    {
+        task* next = 0;
+        {
+            task_queue& own = *queues[index];
+            boost::mutex::scoped_lock lock(own.lock);
+            if(!own.tasks.empty()) 
+            {
+                next = own.tasks.back();
+                own.tasks.pop_back();
+            }
+        }
+
+        //steal from the other queues, starting with the next one so that 
+        //threads do not all steal from the same queue.
+        for(std::size_t offset = 1; !next && offset < queues.size(); ++offset)
+        {
+            task_queue& victim = *queues[(index + offset) % queues.size()];
+            boost::mutex::scoped_lock lock(victim.lock);
+            if(!victim.tasks.empty())
+            {
+                next = victim.tasks.front();
+                victim.tasks.pop_front();
+            }
+        }
+        if(!next) return false;
+
+        (*next)();
+
+        boost::mutex::scoped_lock lock(state_lock);
+        if(--remaining == 0) work_done.notify_all();
+        return true;
+    }
+}//namespace ncc
@@ -25,8 +25,8 @@ function initialize(params)
 	end
 end
 
-function collision_callback(object)
-	if object.id == 2 then
+function collision_callback(object, info)
+	if info.state == ncc.collision_info.contact_begin and object.id == 2 then
 		game:remove_self();	
 	end 
 	return true;
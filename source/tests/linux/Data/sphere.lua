@@ -18,8 +18,8 @@ function initialize(params)
 	end
 end
 
-function collision_callback(object)
-	if object.id == 1 then
+function collision_callback(object, info)
+	if info.state == ncc.collision_info.contact_begin and object.id == 1 then
 		game:remove_self();
 	end 
 	return true;
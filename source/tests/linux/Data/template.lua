@@ -11,6 +11,10 @@ function control()
 end
 
 function handle_message(message, params, from)
+	--from is the handle of the sender. game:get_controller(from) returns
+	--the sender, or nil if it is gone.
+	--Keep the handle rather than the sender, which is only valid until
+	--handle_message returns.
 	
 end
 
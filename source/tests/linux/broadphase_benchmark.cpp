@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "object/ode/ode_policies.h"
+#include "object/object_utilities.h"
+#include "object/object.h"
+#include "utilities/clock.h"
+
+//This is a benchmark of the broadphase spaces of the ode::manager. The same
+//scene of boxes scattered over a large level, with a dense pile in the 
+//middle, is built in each space. For each space it reports how many pairs 
+//the broadphase passed to the near callback and how long a collision pass 
+//took.
+
+//A box which is only simulated, nothing is drawn.
+typedef ncc::object::object<ncc::object::invisible, ncc::ode::box> physical_box;
+typedef boost::shared_ptr<physical_box> physical_box_ptr;
+
+const double LEVEL_SIZE = 1000;
+const int SCATTERED_COUNT = 4000;
+const int PILE_COUNT = 1000;
+const int PASSES = 20;
+
+struct pair_counter
+{
+    ncc::ode::manager* ode_manager;
+    unsigned long pairs;
+};
+
+//Counts the pair and passes it on to the callback of the manager.
+void counting_near_callback(void* data, dGeomID o1, dGeomID o2)
+{
+    pair_counter* counter = reinterpret_cast<pair_counter*>(data);
+    ++counter->pairs;
+    ncc::ode::near_callback(counter->ode_manager, o1, o2);
+}
+
+double random_between(double low, double high)
+{
+    return low + (high - low) * (std::rand() / static_cast<double>(RAND_MAX));
+}
+
+void run(const std::string& name, const ncc::ode::space_settings& space)
+{
+    ncc::ode::manager odeManager(0.2, 1e-5, space);
+    odeManager.set_gravity(0, 0, -9.8);
+
+    physical_box ground;
+    ground.create_physical_body(0, 0, 0, LEVEL_SIZE, LEVEL_SIZE, 1, 0, odeManager);
+
+    //every space gets the same scene.
+    std::srand(1);
+    std::vector<physical_box_ptr> boxes;
+    for(int index = 0; index < SCATTERED_COUNT + PILE_COUNT; ++index)
+    {
+        const double spread = index < SCATTERED_COUNT ? LEVEL_SIZE / 2 - 1 : 5;
+        physical_box_ptr box(new physical_box);
+        box->create_physical_body(
+                random_between(-spread, spread), 
+                random_between(-spread, spread), 
+                random_between(1, 20),
+                1, 1, 1, 1, odeManager);
+        boxes.push_back(box);
+    }
+
+    //let the boxes land.
+    for(int step = 0; step < 50; ++step) odeManager.step(0.02);
+
+    pair_counter counter = { &odeManager, 0};
+    const double start = ncc::monotonic_seconds();
+    for(int pass = 0; pass < PASSES; ++pass)
+    {
+        dSpaceCollide(odeManager.ode_space(), reinterpret_cast<void*>(&counter), counting_near_callback);
+        dSpaceCollide2(reinterpret_cast<dGeomID>(odeManager.ode_space()), reinterpret_cast<dGeomID>(odeManager.ode_static_space()), 
+                reinterpret_cast<void*>(&counter), counting_near_callback);
+        dJointGroupEmpty(odeManager.contact_group());
+    }
+    const double seconds = (ncc::monotonic_seconds() - start) / PASSES;
+
+    std::cout << name << ": " 
+        << counter.pairs / PASSES << " pairs tested, " 
+        << seconds * 1000.0 << " ms per pass" << std::endl;
+}
+
+int main(int argc, const char** argv)
+{
+    typedef ncc::ode::space_settings settings;
+    const double half = LEVEL_SIZE / 2;
+
+    std::cout << "boxes: " << SCATTERED_COUNT + PILE_COUNT << std::endl;
+    run("simple", settings(settings::simple));
+    run("hash", settings(settings::hash));
+    run("hash fitted", settings::fit(settings::hash, -half, -half, -1, half, half, 30));
+    run("quadtree", settings(settings::quadtree));
+    run("quadtree fitted", settings::fit(settings::quadtree, -half, -half, -1, half, half, 30));
+    run("sweep and prune", settings(settings::sweep_and_prune));
+    return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "object/ode/ode_policies.h"
+#include "object/object_utilities.h"
+#include "object/object.h"
+#include "utilities/clock.h"
+
+//This is a microbenchmark of the collision callback. It drops a pile of 5000
+//boxes on the ground, lets them settle, and then times the collision pass of 
+//the ode::manager against the callback the library used before materials 
+//were looked up in a table. Both callbacks must create the same contacts,
+//otherwise the timings are not comparable and the benchmark fails.
+
+//A box which is only simulated, nothing is drawn.
+class physical_box : public ncc::object::object<ncc::object::invisible, ncc::ode::box>
+{
+    public:
+        dBodyID body() const { return body_id;}
+};
+typedef boost::shared_ptr<physical_box> physical_box_ptr;
+
+//The old callback asked both objects for their friction and bounce, filled 
+//every contact before colliding, and cast the objects on every collision.
+void reference_near_callback(void* mgr, dGeomID o1, dGeomID o2)
+{
+    ncc::ode::manager* ode_manager = reinterpret_cast<ncc::ode::manager*>(mgr);
+    const int MAX_CONTACTS = 64;
+    dBodyID b1 = dGeomGetBody(o1);
+    dBodyID b2 = dGeomGetBody(o2);
+    if (b1 && b2 && dAreConnectedExcluding (b1,b2,dJointTypeContact)) return;
+
+    const ncc::ode::geom_data* data_1 = reinterpret_cast<const ncc::ode::geom_data*>(dGeomGetData(o1));
+    const ncc::ode::geom_data* data_2 = reinterpret_cast<const ncc::ode::geom_data*>(dGeomGetData(o2));
+    if(!data_1 || !data_2) return;
+    ncc::ode::object* object_1 = data_1->owner;
+    ncc::ode::object* object_2 = data_2->owner;
+
+    const double friction = std::sqrt(object_1->get_friction() * object_2->get_friction());
+    const double bounce = (object_2->get_bounce() + object_1->get_bounce()) / 2.0;
+
+    dContact contact[MAX_CONTACTS];
+    dContact object_contact;
+    object_contact.surface.mode = dContactBounce | dContactSoftCFM;
+    object_contact.surface.mu = friction == -1 ? dInfinity : friction;
+    object_contact.surface.mu2 = object_contact.surface.mu;
+    object_contact.surface.bounce = bounce;
+    object_contact.surface.bounce_vel = 0.01;
+    object_contact.surface.soft_cfm = 0.001;
+    for (int i=0; i<MAX_CONTACTS; i++) 
+        contact[i] = object_contact;
+
+    if (int numc = dCollide (o1,o2,MAX_CONTACTS,&contact[0].geom,sizeof(dContact))) 
+    {
+        ncc::ode::collision_callback callback1 = object_1->callback();
+        ncc::ode::collision_callback callback2 = object_2->callback();
+        ncc::ode::collision_info collision1 = { 0,dynamic_cast<ncc::object::abstract_interface*>(object_1), dynamic_cast<ncc::object::abstract_interface*>(object_2)};
+        ncc::ode::collision_info collision2 = { 0, dynamic_cast<ncc::object::abstract_interface*>(object_2), dynamic_cast<ncc::object::abstract_interface*>(object_1)};
+        bool create_joints = true;
+        if(callback1 || callback2)
+        {
+            const bool col1 = callback1 ? callback1(collision1) : false;
+            const bool col2 = callback2 ? callback2(collision2) : false;
+            create_joints = col1 || col2;
+        }
+        if(create_joints)
+            for (int i=0; i<numc; i++) 
+            {
+                dJointID c = dJointCreateContact (ode_manager->ode_world(),ode_manager->contact_group(),&contact[i]);
+                dJointAttach (c,b1,b2);
+            }
+    }
+}
+
+//Returns the average seconds of a collision pass with the callback.
+double time_collisions(ncc::ode::manager& odeManager, dNearCallback* callback, int passes)
+{
+    const double start = ncc::monotonic_seconds();
+    for(int pass = 0; pass < passes; ++pass)
+    {
+        dSpaceCollide(odeManager.ode_space(), reinterpret_cast<void*>(&odeManager), callback);
+        dSpaceCollide2(reinterpret_cast<dGeomID>(odeManager.ode_space()), reinterpret_cast<dGeomID>(odeManager.ode_static_space()), 
+                reinterpret_cast<void*>(&odeManager), callback);
+        dJointGroupEmpty(odeManager.contact_group());
+        odeManager.clear_collisions();
+    }
+    return (ncc::monotonic_seconds() - start) / passes;
+}
+
+//Returns the number of contact joints one collision pass with the callback
+//attaches to the boxes.
+unsigned long count_contacts(ncc::ode::manager& odeManager, dNearCallback* callback, 
+        const std::vector<physical_box_ptr>& boxes)
+{
+    dSpaceCollide(odeManager.ode_space(), reinterpret_cast<void*>(&odeManager), callback);
+    dSpaceCollide2(reinterpret_cast<dGeomID>(odeManager.ode_space()), reinterpret_cast<dGeomID>(odeManager.ode_static_space()), 
+            reinterpret_cast<void*>(&odeManager), callback);
+    unsigned long contacts = 0;
+    for(std::size_t index = 0; index < boxes.size(); ++index)
+        contacts += dBodyGetNumJoints(boxes[index]->body());
+    dJointGroupEmpty(odeManager.contact_group());
+    odeManager.clear_collisions();
+    return contacts;
+}
+
+int main(int argc, const char** argv)
+{
+    const int BOX_COUNT = 5000;
+    const int PASSES = 50;
+
+    ncc::ode::manager odeManager;
+    odeManager.set_gravity(0, 0, -9.8);
+
+    physical_box ground;
+    ground.create_physical_body(0, 0, 0, 200, 200, 1, 0, odeManager);
+    ground.set_friction(1.0);
+
+    //the boxes are dropped in columns so that they land on each other.
+    std::vector<physical_box_ptr> boxes;
+    const int side = static_cast<int>(std::sqrt(static_cast<double>(BOX_COUNT / 10)));
+    for(int index = 0; index < BOX_COUNT; ++index)
+    {
+        const int column = index % (side * side);
+        const int level = index / (side * side);
+        physical_box_ptr box(new physical_box);
+        box->create_physical_body(
+                (column % side) * 1.05 - side / 2, 
+                (column / side) * 1.05 - side / 2, 
+                1.5 + level * 1.1,
+                1, 1, 1, 1, odeManager);
+        box->set_friction(0.6);
+        box->set_bounce(index % 2 ? 0.3 : 0.1);
+        boxes.push_back(box);
+    }
+
+    //let the pile settle so that most boxes touch.
+    for(int step = 0; step < 100; ++step) odeManager.step(0.02);
+
+    //a pass of each first so that both start warm, which also checks that
+    //they create the same contacts.
+    const unsigned long reference_contacts = count_contacts(odeManager, reference_near_callback, boxes);
+    const unsigned long table_contacts = count_contacts(odeManager, ncc::ode::near_callback, boxes);
+    if(reference_contacts != table_contacts)
+    {
+        std::cout << "the callbacks disagree: " << reference_contacts << " and " 
+            << table_contacts << " contacts" << std::endl;
+        return 1;
+    }
+
+    const double reference = time_collisions(odeManager, reference_near_callback, PASSES);
+    const double table = time_collisions(odeManager, ncc::ode::near_callback, PASSES);
+
+    std::cout << "boxes: " << BOX_COUNT << std::endl;
+    std::cout << "contacts per pass: " << table_contacts << std::endl;
+    std::cout << "reference callback: " << reference * 1000.0 << " ms per pass" << std::endl;
+    std::cout << "material table callback: " << table * 1000.0 << " ms per pass" << std::endl;
+    std::cout << "speedup: " << reference / table << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#include "controller/controller_manager.h"
+#include "utilities/clock.h"
+#include <boost/thread/thread.hpp>
+#include <iostream>
+
+//This test checks the update intervals of controllers. A controller with an
+//interval is only controlled once the interval has passed, while its 
+//children and the controllers without one are controlled on every step.
+//Low priority controllers are controlled once every so many steps.
+class counter : public ncc::controller::abstract_interface
+{
+    public:
+        counter() : controlled(0) {}
+        std::string get_type() { return "counter";}
+        bool initialize(const ncc::parameter_list&) { return true;}
+        bool control() { ++controlled; return true;}
+        int controlled;
+};
+typedef boost::shared_ptr<counter> counter_ptr;
+
+int main(int argc, const char** argv)
+{
+    ncc::controller::manager manager;
+    counter_ptr every_step(new counter);
+    counter_ptr interval(new counter);
+    counter_ptr child(new counter);
+    manager.add_controller(every_step);
+    manager.add_controller(interval);
+    ncc::controller::ptr parent = interval;
+    manager.add_controller(child, parent);
+    interval->set_update_interval(0.05);
+
+    const int steps = 40;
+    const double start = ncc::monotonic_seconds();
+    for(int step = 0; step < steps; ++step)
+    {
+        manager.step();
+        boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+    }
+    const double elapsed = ncc::monotonic_seconds() - start;
+
+    int failures = 0;
+    if(every_step->controlled != steps) ++failures;
+    if(child->controlled != steps) ++failures;
+    //the first step controls it, then once per interval at most.
+    if(interval->controlled < 2 || interval->controlled > 1 + static_cast<int>(elapsed / 0.05)) ++failures;
+
+    //an interval of 0 controls it on every step again.
+    interval->set_update_interval(0);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(60));
+    interval->controlled = 0;
+    for(int step = 0; step < 10; ++step) manager.step();
+    if(interval->controlled != 10) ++failures;
+
+    //each of the 4 buckets is controlled on one step out of 4.
+    std::vector<counter_ptr> low_priority;
+    for(int index = 0; index < 16; ++index)
+    {
+        low_priority.push_back(counter_ptr(new counter));
+        low_priority.back()->set_low_priority(true);
+        manager.add_controller(low_priority.back());
+    }
+    manager.set_low_priority_buckets(4);
+    for(int step = 0; step < 8; ++step) manager.step();
+    for(std::size_t index = 0; index < low_priority.size(); ++index)
+        if(low_priority[index]->controlled != 2) ++failures;
+
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
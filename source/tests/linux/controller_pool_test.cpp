@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#include "controller/controller_manager.h"
+#include <iostream>
+
+//This test checks the pools of prototypes. A dead controller created from a 
+//pooled prototype is recycled and handed out again instead of being 
+//deleted, one which is still held when it dies is recycled once it is 
+//released, a dead parent and child are both recycled, and the controllers 
+//which do not fit in the pool are deleted.
+int recycled = 0;
+int deleted = 0;
+
+class bullet : public ncc::controller::abstract_interface
+{
+    public:
+        ~bullet() { ++deleted;}
+        std::string get_type() { return "bullet";}
+        bool initialize(const ncc::parameter_list&) { return true;}
+        bool control() { return true;}
+        abstract_interface* clone_prototype() { return new bullet;}
+        bool recycle() { ++recycled; return true;}
+};
+
+//Returns 1 if the recycled and deleted counts are not the expected ones.
+int check(int expected_recycled, int expected_deleted)
+{
+    return recycled == expected_recycled && deleted == expected_deleted ? 0 : 1;
+}
+
+//Removes a controller through its id.
+void remove(ncc::controller::manager& manager, const ncc::controller::ptr& controller)
+{
+    manager.remove_controller(static_cast<const ncc::id_type&>(*controller));
+}
+
+int main(int argc, const char** argv)
+{
+    int failures = 0;
+    {
+        ncc::controller::manager manager;
+        ncc::controller::ptr prototype(new bullet);
+        manager.add_prototype("bullet", prototype);
+        manager.set_prototype_pool("bullet", 2);
+        const ncc::parameter_list params;
+
+        //a dead controller is recycled and handed out again.
+        ncc::controller::ptr first = manager.add_controller("bullet", params).lock();
+        bullet* first_address = static_cast<bullet*>(first.get());
+        remove(manager, first);
+        first.reset();
+        manager.step();
+        failures += check(1, 0);
+        first = manager.add_controller("bullet", params).lock();
+        if(first.get() != first_address) ++failures;
+
+        //a controller still held when it dies is recycled after it is 
+        //released.
+        remove(manager, first);
+        manager.step();
+        failures += check(1, 0);
+        first.reset();
+        manager.step();
+        failures += check(2, 0);
+
+        //a dead parent and child are both recycled.
+        ncc::controller::ptr parent = manager.add_controller("bullet", params).lock();
+        ncc::controller::ptr child = manager.add_controller("bullet", params, parent).lock();
+        if(parent.get() != first_address) ++failures;
+        bullet* child_address = static_cast<bullet*>(child.get());
+        remove(manager, parent);
+        parent.reset();
+        child.reset();
+        manager.step();
+        failures += check(4, 0);
+        ncc::controller::ptr reused[] = {
+            manager.add_controller("bullet", params).lock(),
+            manager.add_controller("bullet", params).lock()};
+        if(!(reused[0].get() == first_address && reused[1].get() == child_address) && 
+                !(reused[0].get() == child_address && reused[1].get() == first_address)) 
+            ++failures;
+
+        //the pool holds 2, so the third dead controller is deleted.
+        ncc::controller::ptr extra = manager.add_controller("bullet", params).lock();
+        for(int index = 0; index < 2; ++index) remove(manager, reused[index]);
+        remove(manager, extra);
+        reused[0].reset();
+        reused[1].reset();
+        extra.reset();
+        manager.step();
+        failures += check(7, 1);
+    }
+    //the pooled controllers and the prototype die with the manager.
+    failures += check(7, 4);
+
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
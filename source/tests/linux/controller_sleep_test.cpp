@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#include "controller/controller_manager.h"
+#include <boost/thread/thread.hpp>
+#include <iostream>
+
+//This test checks sleeping controllers. A sleeping controller and its 
+//children are skipped until it is woken, a message wakes it, and a 
+//controller put to sleep for a time wakes by itself once it has passed.
+class sleeper : public ncc::controller::abstract_interface
+{
+    public:
+        sleeper() : controlled(0), received(0) {}
+        std::string get_type() { return "sleeper";}
+        bool initialize(const ncc::parameter_list&) { return true;}
+        bool control() { ++controlled; return true;}
+        void handle_message(const ncc::parameter& message, const ncc::parameter_list& params, ncc::controller::abstract_interface& from)
+        {
+            ++received;
+        }
+        int controlled;
+        int received;
+};
+typedef boost::shared_ptr<sleeper> sleeper_ptr;
+
+//Steps the manager the specified number of times and returns the number of 
+//the controllers whose control count is not the expected one, then resets 
+//the counts.
+int check(ncc::controller::manager& manager, int steps, sleeper_ptr* sleepers, const int* expected, int count)
+{
+    for(int step = 0; step < steps; ++step) manager.step();
+    int failures = 0;
+    for(int index = 0; index < count; ++index)
+    {
+        if(sleepers[index]->controlled != expected[index]) ++failures;
+        sleepers[index]->controlled = 0;
+    }
+    return failures;
+}
+
+int main(int argc, const char** argv)
+{
+    ncc::controller::manager manager;
+    sleeper_ptr sleepers[] = {
+        sleeper_ptr(new sleeper),
+        sleeper_ptr(new sleeper),
+        sleeper_ptr(new sleeper)};
+    const int count = 3;
+    sleeper_ptr parent = sleepers[0], child = sleepers[1], other = sleepers[2];
+    manager.add_controller(parent);
+    ncc::controller::ptr parent_ptr = parent;
+    manager.add_controller(child, parent_ptr);
+    manager.add_controller(other);
+
+    int failures = 0;
+    const int awake[] = {3, 3, 3};
+    failures += check(manager, 3, sleepers, awake, count);
+
+    //the parent and its child are skipped while it sleeps.
+    parent->sleep();
+    if(!parent->is_sleeping()) ++failures;
+    const int asleep[] = {0, 0, 3};
+    failures += check(manager, 3, sleepers, asleep, count);
+
+    //a message wakes it.
+    manager.send_message(other.get(), parent_ptr, std::string("wake up"));
+    manager.step();
+    if(parent->received != 1 || parent->is_sleeping()) ++failures;
+    for(int index = 0; index < count; ++index) sleepers[index]->controlled = 0;
+    const int woken[] = {2, 2, 2};
+    failures += check(manager, 2, sleepers, woken, count);
+
+    //sleeping for a time wakes it on the first step after the time.
+    child->sleep(0.05);
+    const int child_asleep[] = {3, 0, 3};
+    failures += check(manager, 3, sleepers, child_asleep, count);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(60));
+    const int child_awake[] = {2, 2, 2};
+    failures += check(manager, 2, sleepers, child_awake, count);
+    if(child->is_sleeping()) ++failures;
+
+    //a controller woken directly is controlled on the next step.
+    other->sleep();
+    manager.step();
+    other->wake();
+    for(int index = 0; index < count; ++index) sleepers[index]->controlled = 0;
+    const int woken_directly[] = {1, 1, 1};
+    failures += check(manager, 1, sleepers, woken_directly, count);
+
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
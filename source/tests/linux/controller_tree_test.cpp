@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+#include "controller/controller_manager.h"
+#include <iostream>
+
+//This test checks that a controller can add siblings to its parent during
+//control. Adding a child may move the array of children of the parent, so 
+//the controller being controlled must not be referred to through it.
+class spawner : public ncc::controller::abstract_interface
+{
+    public:
+        spawner(int spawn_count) : spawns(spawn_count), controlled(0) {}
+        std::string get_type() { return "spawner";}
+        bool initialize(const ncc::parameter_list&) { return true;}
+        bool control()
+        {
+            ++controlled;
+            //siblings are added one at a time so the array grows several times.
+            for(; spawns > 0; --spawns) 
+                parent().add_child(ncc::controller::ptr(new spawner(0)));
+            return true;
+        }
+        int spawns;
+        int controlled;
+};
+
+int main(int argc, const char** argv)
+{
+    ncc::controller::manager manager;
+    ncc::controller::ptr group(new spawner(0));
+    manager.add_controller(group);
+    manager.add_controller(ncc::controller::ptr(new spawner(32)), group);
+    manager.add_controller(ncc::controller::ptr(new spawner(0)), group);
+
+    manager.step();
+
+    //every child, including the ones spawned during the step, must have been
+    //controlled once.
+    int failures = 0;
+    const ncc::controller::abstract_interface::child_list_type& children = group->children();
+    if(children.size() != 34) ++failures;
+    for(std::size_t child = 0; child < children.size(); ++child)
+        if(static_cast<spawner&>(*children[child]).controlled != 1) ++failures;
+
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
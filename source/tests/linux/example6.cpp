@@ -120,8 +120,10 @@ class EnemyController : public ncc::controller::abstract_interface
         bool collision_callback(const ncc::ode::collision_info info)
         {
             //a bullet has an id of 1 so we 
-            //destroy the enemy when the bullet collides with it.
-            if(info.object_2->get_id() == 1)
+            //destroy the enemy when the bullet collides with it. The callback
+            //is called every step the objects touch, so only the first 
+            //contact counts.
+            if(info.state == ncc::ode::collision_info::contact_begin && info.object_2->get_id() == 1)
                 remove_self();
             return true;
         }
@@ -229,7 +231,7 @@ class BulletController : public ncc::controller::abstract_interface
             //an enemy has an id of 2 so we
             //will destroy our bullet when it hits
             //the enemy.
-            if(info.object_2->get_id() == 2)
+            if(info.state == ncc::ode::collision_info::contact_begin && info.object_2->get_id() == 2)
                 remove_self();
             return true;
         }
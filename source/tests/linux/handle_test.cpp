@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#include "controller/controller_manager.h"
+#include "elements/handle.h"
+#include <iostream>
+
+//This test checks handles and ids. A handle finds its object until it is 
+//released, and a released handle stays invalid after its slot is reused by
+//another object, whether the table is used directly or through the 
+//controller manager. A copy of an id_type keeps the id it was copied from.
+class blank : public ncc::controller::abstract_interface
+{
+    public:
+        std::string get_type() { return "blank";}
+        bool initialize(const ncc::parameter_list&) { return true;}
+        bool control() { return true;}
+};
+
+//Creates, releases, and reuses the slots of a handle table.
+int table_handles()
+{
+    int failures = 0;
+    ncc::handle_table<int> table;
+    int first = 1, second = 2;
+    const ncc::handle first_handle = table.create(&first);
+    if(first_handle.is_null() || table.get(first_handle) != &first || table.size() != 1) ++failures;
+
+    if(!table.release(first_handle) || table.release(first_handle)) ++failures;
+    if(table.is_valid(first_handle) || table.size() != 0) ++failures;
+
+    //the slot is reused with a new generation.
+    const ncc::handle second_handle = table.create(&second);
+    if(second_handle.get_index() != first_handle.get_index()) ++failures;
+    if(second_handle.get_generation() == first_handle.get_generation()) ++failures;
+    if(table.get(first_handle) || table.get(second_handle) != &second) ++failures;
+    if(table.release(first_handle) || !table.is_valid(second_handle)) ++failures;
+
+    if(table.get(ncc::handle())) ++failures;
+    return failures;
+}
+
+//Removes a controller and checks its handle does not find the controller 
+//which takes its slot.
+int controller_handles()
+{
+    int failures = 0;
+    ncc::controller::manager manager;
+    ncc::controller::ptr removed(new blank);
+    manager.add_controller(removed);
+    const ncc::handle old_handle = removed->get_handle();
+    if(manager.get_controller(old_handle) != removed.get()) ++failures;
+
+    manager.remove_controller(removed);
+    manager.step();
+    if(manager.get_controller(old_handle)) ++failures;
+
+    ncc::controller::ptr added(new blank);
+    manager.add_controller(added);
+    const ncc::handle new_handle = added->get_handle();
+    if(new_handle == old_handle) ++failures;
+    if(manager.get_controller(old_handle) || manager.get_controller(new_handle) != added.get()) ++failures;
+    return failures;
+}
+
+//Copies and assigns ids.
+int copied_ids()
+{
+    int failures = 0;
+    blank first, second;
+    if(first.get_id() == second.get_id()) ++failures;
+    const ncc::id_type& id = first;
+    ncc::id_type copy(id);
+    if(copy.get_id() != first.get_id() || !(copy == id)) ++failures;
+    ncc::id_type assigned;
+    assigned = second;
+    if(assigned.get_id() != second.get_id() || !(second.get_id() == assigned)) ++failures;
+    return failures;
+}
+
+int main(int argc, const char** argv)
+{
+    int failures = 0;
+    failures += table_handles();
+    failures += controller_handles();
+    failures += copied_ids();
+
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
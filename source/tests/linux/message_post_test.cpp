@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#include "controller/controller_manager.h"
+#include <boost/thread/thread.hpp>
+#include <boost/atomic.hpp>
+#include <iostream>
+#include <vector>
+
+//This test checks messages sent from other threads while the manager steps.
+//They go through the lock free queue of the message manager, and every one
+//of them must be delivered exactly once with its parameters intact.
+const int senders = 4;
+const int messages_per_sender = 2000;
+
+class receiver : public ncc::controller::abstract_interface
+{
+    public:
+        receiver() : received(senders * messages_per_sender, 0), bad(0) {}
+        std::string get_type() { return "receiver";}
+        bool initialize(const ncc::parameter_list&) { return true;}
+        bool control() { return true;}
+        void handle_message(const ncc::parameter& message, const ncc::parameter_list& params, ncc::controller::abstract_interface& from)
+        {
+            if(params.size() != 2) { ++bad; return;}
+            const int sender = ncc::get<int>(params.at(0));
+            const int index = ncc::get<int>(params.at(1));
+            if(sender < 0 || sender >= senders || index < 0 || index >= messages_per_sender) { ++bad; return;}
+            ++received[sender * messages_per_sender + index];
+        }
+        std::vector<int> received;
+        int bad;
+};
+
+ncc::controller::manager* stepping_manager = 0;
+ncc::controller::abstract_interface* sender_controller = 0;
+boost::atomic<int> finished(0);
+
+//Sends the messages of one sender.
+void send_messages(int sender)
+{
+    for(int index = 0; index < messages_per_sender; ++index)
+        stepping_manager->send_message(sender_controller, "receiver", std::string("count"))(sender)(index);
+    ++finished;
+}
+
+int main(int argc, const char** argv)
+{
+    ncc::controller::manager controller_manager;
+    stepping_manager = &controller_manager;
+    boost::shared_ptr<receiver> target(new receiver);
+    boost::shared_ptr<receiver> source(new receiver);
+    target->set_name("receiver");
+    controller_manager.add_controller(target);
+    controller_manager.add_controller(source);
+    sender_controller = source.get();
+    controller_manager.step();
+
+    boost::thread_group threads;
+    for(int sender = 0; sender < senders; ++sender)
+        threads.create_thread(boost::bind(&send_messages, sender));
+    while(finished < senders) controller_manager.step();
+    threads.join_all();
+    controller_manager.step();
+
+    int failures = target->bad;
+    for(std::size_t index = 0; index < target->received.size(); ++index)
+        if(target->received[index] != 1) ++failures;
+
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#include "controller/controller_manager.h"
+#include <iostream>
+
+//This test checks that messages reach exactly the controllers they are 
+//routed to, whether they are sent by name, by type, to one controller, or 
+//to every controller, and that a message to a controller which is gone is 
+//dropped.
+class listener : public ncc::controller::abstract_interface
+{
+    public:
+        listener(const std::string& controller_type) : type(controller_type), received(0) {}
+        std::string get_type() { return type;}
+        bool initialize(const ncc::parameter_list&) { return true;}
+        bool control() { return true;}
+        void handle_message(const ncc::parameter& message, const ncc::parameter_list& params, ncc::controller::abstract_interface& from)
+        {
+            ++received;
+            last = ncc::get<std::string>(message);
+        }
+        std::string type;
+        int received;
+        std::string last;
+};
+typedef boost::shared_ptr<listener> listener_ptr;
+
+//Returns the number of listeners whose received count is not the expected 
+//one, then resets the counts.
+int check(listener_ptr* listeners, const int* expected, int count)
+{
+    int failures = 0;
+    for(int index = 0; index < count; ++index)
+    {
+        if(listeners[index]->received != expected[index]) ++failures;
+        listeners[index]->received = 0;
+    }
+    return failures;
+}
+
+int main(int argc, const char** argv)
+{
+    ncc::controller::manager manager;
+    listener_ptr listeners[] = {
+        listener_ptr(new listener("ship")),
+        listener_ptr(new listener("ship")),
+        listener_ptr(new listener("rock")),
+        listener_ptr(new listener("rock"))};
+    const int count = 4;
+    for(int index = 0; index < count; ++index) manager.add_controller(listeners[index]);
+    listeners[0]->set_name("player");
+    listeners[2]->set_name("player");
+    listener_ptr sender = listeners[3];
+
+    int failures = 0;
+    manager.send_message(sender.get(), "player", std::string("by name"));
+    manager.step();
+    const int by_name[] = {1, 0, 1, 0};
+    failures += check(listeners, by_name, count);
+
+    manager.send_message_to_all(sender.get(), "ship", std::string("by type"));
+    manager.step();
+    const int by_type[] = {1, 1, 0, 0};
+    failures += check(listeners, by_type, count);
+
+    ncc::controller::ptr recipient = listeners[1];
+    manager.send_message(sender.get(), recipient, std::string("to one"));
+    manager.step();
+    const int to_one[] = {0, 1, 0, 0};
+    failures += check(listeners, to_one, count);
+    if(listeners[1]->last != "to one") ++failures;
+
+    //the handle of a controller finds it until it is removed.
+    const ncc::handle removed_handle = listeners[1]->get_handle();
+    if(manager.get_controller(removed_handle) != listeners[1].get()) ++failures;
+
+    manager.send_message_to_all(sender.get(), std::string("to all"));
+    manager.step();
+    const int to_all[] = {1, 1, 1, 1};
+    failures += check(listeners, to_all, count);
+
+    //a renamed controller is found by its new name only.
+    listeners[2]->set_name("rock");
+    manager.send_message(sender.get(), "player", std::string("renamed"));
+    manager.step();
+    const int renamed[] = {1, 0, 0, 0};
+    failures += check(listeners, renamed, count);
+
+    //a message to a controller which was removed is dropped.
+    manager.remove_controller(recipient);
+    manager.step();
+    manager.send_message(sender.get(), recipient, std::string("too late"));
+    manager.step();
+    const int dropped[] = {0, 0, 0, 0};
+    failures += check(listeners, dropped, count);
+    if(manager.get_controller(removed_handle)) ++failures;
+
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
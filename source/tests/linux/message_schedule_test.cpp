@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#include "controller/controller_manager.h"
+#include <boost/thread/thread.hpp>
+#include <iostream>
+
+//This test checks the schedule of the message manager. A timed message is
+//not sent before it is due, messages due at different times are sent in 
+//the order they are due, and a polled condition is only checked at its 
+//interval while a condition without one is checked on every step.
+class listener : public ncc::controller::abstract_interface
+{
+    public:
+        std::string get_type() { return "listener";}
+        bool initialize(const ncc::parameter_list&) { return true;}
+        bool control() { return true;}
+        void handle_message(const ncc::parameter& message, const ncc::parameter_list& params, ncc::controller::abstract_interface& from)
+        {
+            received.push_back(ncc::get<int>(message));
+        }
+        std::vector<int> received;
+};
+
+//Counts the times it is checked and sends once ready is set.
+struct counted : public ncc::controller::message::condition::polled
+{
+    counted(double interval, int& check_count, const bool& is_ready) : 
+        polled(interval), checks(check_count), ready(is_ready) {}
+    bool send() const { ++checks; return ready;}
+    int& checks;
+    const bool& ready;
+};
+
+void wait(double seconds)
+{
+    boost::this_thread::sleep(boost::posix_time::milliseconds(static_cast<long>(seconds * 1000)));
+}
+
+int main(int argc, const char** argv)
+{
+    namespace message = ncc::controller::message;
+    ncc::controller::manager manager;
+    boost::shared_ptr<listener> target(new listener);
+    ncc::controller::ptr recipient = target;
+    manager.add_controller(recipient);
+
+    int failures = 0;
+
+    //the later message is sent first and the earlier one overtakes it.
+    message::condition::ptr later(new message::condition::timed(0.1));
+    message::condition::ptr earlier(new message::condition::timed(0.05));
+    manager.send_message(target.get(), recipient, message::parcel(1, later));
+    manager.send_message(target.get(), recipient, message::parcel(2, earlier));
+    manager.step();
+    if(!target->received.empty()) ++failures;
+    wait(0.15);
+    manager.step();
+    if(target->received.size() != 2 || target->received[0] != 2 || target->received[1] != 1) ++failures;
+    target->received.clear();
+
+    //a polled condition is checked about every 50ms, not on every step.
+    int polled_checks = 0;
+    int unscheduled_checks = 0;
+    bool ready = false;
+    message::condition::ptr polled(new counted(0.05, polled_checks, ready));
+    message::condition::ptr unscheduled(new counted(0, unscheduled_checks, ready));
+    manager.send_message(target.get(), recipient, message::parcel(3, polled));
+    manager.send_message(target.get(), recipient, message::parcel(4, unscheduled));
+    const int steps = 50;
+    for(int step = 0; step < steps; ++step)
+    {
+        manager.step();
+        wait(0.002);
+    }
+    if(!target->received.empty()) ++failures;
+    if(unscheduled_checks != steps) ++failures;
+    if(polled_checks < 1 || polled_checks > steps / 5) ++failures;
+
+    //both are sent once the condition holds and the interval has passed.
+    ready = true;
+    wait(0.06);
+    manager.step();
+    if(target->received.size() != 2) ++failures;
+
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+#include "object/object.h"
+#include "object/object_utilities.h"
+#include "object/object_manager.h"
+#include <iostream>
+
+//This test checks that objects removed by other objects during step do not
+//make the manager skip or repeat any object. Removing an object moves the 
+//last object of the array into its place. It also checks that an object is 
+//only in one manager at a time.
+typedef ncc::object::object<ncc::object::invisible, ncc::object::ghost> ghost_object;
+
+class remover : public ghost_object
+{
+    public:
+        remover(ncc::object::manager& object_manager) : 
+            manager(object_manager), target(0), updates(0), removed(false), removed_before_update(false) {}
+        void update()
+        {
+            ghost_object::update();
+            ++updates;
+            if(target && !target->removed)
+            {
+                target->removed = true;
+                if(!target->updates) target->removed_before_update = true;
+                manager.remove_object(target);
+                if(restore) manager.add_object(restore);
+            }
+        }
+        ncc::object::manager& manager;
+        remover* target;
+        ncc::object::ptr restore; ///< added again once target is removed.
+        int updates;
+        bool removed;
+        bool removed_before_update;
+};
+
+//Steps the objects twice and returns the number of failures.
+int step_objects(bool parallel)
+{
+    const int count = 100;
+    ncc::object::manager manager;
+    if(parallel) manager.enable_parallel_step(4);
+    std::vector<boost::shared_ptr<remover> > objects;
+    for(int index = 0; index < count; ++index)
+    {
+        objects.push_back(boost::shared_ptr<remover>(new remover(manager)));
+        manager.add_object(objects.back());
+    }
+    //every third object removes another one, some of which were already 
+    //updated and some of which were not.
+    for(int index = 0; index < count; index += 3) 
+        objects[index]->target = objects[(index * 7 + 5) % count].get();
+    //an object may also remove itself.
+    objects[1]->target = objects[1].get();
+
+    int failures = 0;
+    for(int step = 1; step <= 2; ++step)
+    {
+        manager.step();
+        std::size_t survivors = 0;
+        for(int index = 0; index < count; ++index)
+        {
+            remover& object = *objects[index];
+            if(object.removed_before_update && object.updates) ++failures;
+            if(object.removed) continue;
+            ++survivors;
+            if(object.updates != step) ++failures;
+        }
+        if(manager.size() != survivors) ++failures;
+    }
+    return failures;
+}
+
+//Moves objects between managers and returns the number of failures.
+int move_objects()
+{
+    int failures = 0;
+    ncc::object::manager first;
+    ncc::object::manager second;
+    boost::shared_ptr<remover> moved(new remover(first));
+
+    //an object in a manager cannot be added to another or added twice.
+    if(first.add_object(moved).expired()) ++failures;
+    if(!second.add_object(moved).expired()) ++failures;
+    if(!first.add_object(moved).expired()) ++failures;
+    if(first.get_object(moved->get_handle()) != moved.get()) ++failures;
+
+    //once removed it can.
+    first.remove_object(moved.get());
+    if(second.add_object(moved).expired()) ++failures;
+    if(first.size() != 0 || second.size() != 1) ++failures;
+
+    //an object removed during step and added again stays in the manager.
+    boost::shared_ptr<remover> readder(new remover(second));
+    readder->target = moved.get();
+    readder->restore = moved;
+    second.add_object(readder);
+    second.step();
+    if(second.size() != 2 || second.get_object(moved->get_handle()) != moved.get()) ++failures;
+    const int updates = moved->updates;
+    second.step();
+    if(moved->updates != updates + 1) ++failures;
+
+    //the objects of a destroyed manager can be added to another.
+    second.remove_object(readder.get());
+    {
+        ncc::object::manager destroyed;
+        if(destroyed.add_object(readder).expired()) ++failures;
+    }
+    if(first.add_object(readder).expired()) ++failures;
+    return failures;
+}
+
+int main(int argc, const char** argv)
+{
+    //an overridden update must also be called when stepping in parallel.
+    const int failures = step_objects(false) + step_objects(true) + move_objects();
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}
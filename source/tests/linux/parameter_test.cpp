@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2016  Maxim Noah Khailo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give 
+ * permission to link the code of portions of this program with the 
+ * Botan library under certain conditions as described in each 
+ * individual source file, and distribute linked combinations 
+ * including the two.
+ *
+ * You must obey the GNU General Public License in all respects for 
+ * all of the code used other than Botan. If you modify file(s) with 
+ * this exception, you may extend this exception to your version of the 
+ * file(s), but you are not obligated to do so. If you do not wish to do 
+ * so, delete this exception statement from your version. If you delete 
+ * this exception statement from all source files in the program, then 
+ * also delete it here.
+ */
+
+
+
+#include "elements/parameter.h"
+#include <iostream>
+
+//This test checks the storage of parameters. Objects which fit in a 
+//parameter are kept inline and larger ones on the heap, and both must be 
+//copied and destroyed exactly once, including when a parameter is assigned 
+//from itself or from a parameter held inside it. A parameter_list keeps 
+//its first parameters inline and must copy, grow, and swap whichever way 
+//its parameters are stored.
+int alive = 0;
+
+template<std::size_t size>
+    class tracked
+    {
+        public:
+            tracked(int value = 0) : value(value) { ++alive;}
+            tracked(const tracked& other) : value(other.value) { ++alive;}
+            ~tracked() { --alive;}
+            int value;
+            char padding[size];
+    };
+typedef tracked<4> small_object;
+typedef tracked<128> large_object;
+
+//Returns 1 if a parameter does not hold an object of the type and value.
+template<class type>
+    int check(const ncc::parameter& held, int value)
+    {
+        const type* object = held.cast<type>();
+        return object && object->value == value ? 0 : 1;
+    }
+
+//Copies, assigns, and clears parameters holding the type.
+template<class type>
+    int copy_and_destroy()
+    {
+        int failures = 0;
+        {
+            ncc::parameter first = type(1);
+            ncc::parameter second(first);
+            ncc::parameter third;
+            third = second;
+            failures += check<type>(first, 1) + check<type>(second, 1) + check<type>(third, 1);
+            if(alive != 3) ++failures;
+
+            third = type(2);
+            second = std::string("replaced");
+            failures += check<type>(third, 2);
+            if(alive != 2) ++failures;
+
+            first = first;
+            failures += check<type>(first, 1);
+            first.clear();
+            if(!first.empty() || alive != 1) ++failures;
+        }
+        if(alive != 0) ++failures;
+        return failures;
+    }
+
+//Assigns a parameter from a parameter held by the list it holds.
+template<class type>
+    int assign_from_inside()
+    {
+        int failures = 0;
+        {
+            ncc::parameter outer = ncc::parameters(type(5), type(6));
+            const ncc::parameter_list* inner = outer.cast<ncc::parameter_list>();
+            if(!inner) return 1;
+            outer = (*inner)[1];
+            failures += check<type>(outer, 6);
+            if(alive != 1) ++failures;
+        }
+        if(alive != 0) ++failures;
+        return failures;
+    }
+
+//Grows, copies, and swaps lists stored inline and on the heap.
+int list_storage()
+{
+    int failures = 0;
+    {
+        ncc::parameter_list short_list = ncc::parameters(small_object(0), large_object(1));
+        ncc::parameter_list long_list;
+        for(int index = 0; index < 2 * ncc::parameter_list::inline_capacity; ++index)
+        {
+            if(index % 2) long_list.push_back(large_object(index));
+            else long_list.push_back(small_object(index));
+        }
+        if(short_list.capacity() != ncc::parameter_list::inline_capacity) ++failures;
+        if(long_list.capacity() < long_list.size()) ++failures;
+
+        ncc::parameter_list copy(long_list);
+        for(std::size_t index = 0; index < copy.size(); ++index)
+        {
+            if(index % 2) failures += check<large_object>(copy[index], static_cast<int>(index));
+            else failures += check<small_object>(copy[index], static_cast<int>(index));
+        }
+        if(alive != 2 + 4 * ncc::parameter_list::inline_capacity) ++failures;
+
+        copy = short_list;
+        if(copy.size() != 2) ++failures;
+        failures += check<large_object>(copy[1], 1);
+
+        short_list.swap(long_list);
+        if(short_list.size() != 2 * ncc::parameter_list::inline_capacity || long_list.size() != 2) ++failures;
+        failures += check<small_object>(long_list[0], 0) + check<large_object>(short_list[3], 3);
+
+        try
+        {
+            short_list.at(short_list.size());
+            ++failures;
+        }
+        catch(const std::out_of_range&) {}
+    }
+    if(alive != 0) ++failures;
+    return failures;
+}
+
+int main(int argc, const char** argv)
+{
+    int failures = 0;
+    failures += copy_and_destroy<small_object>();
+    failures += copy_and_destroy<large_object>();
+    failures += assign_from_inside<small_object>();
+    failures += assign_from_inside<large_object>();
+    failures += list_storage();
+
+    std::cout << (failures ? "FAILED" : "passed") << std::endl;
+    return failures ? 1 : 0;
+}